@@ -1,53 +1,130 @@
 #include <SDL2/SDL.h>
 
+#include <algorithm>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string>
 #include <vector>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 #include "ImGui/imgui.h"
 #include "ImGui/imgui_sdl.h"
 #include "ImGui/imgui_impl_sdl.h"
 
+#include "src/benchmark.h"
 #include "src/dataStructuresAndMethods.h"
 #include "src/debugDrawer.h"
 #include "src/enemyBase.h"
 #include "src/enemyManager.h"
+#include "src/frameSpikeRecorder.h"
 #include "src/gameEngine.h"
+#include "src/performanceProfiler.h"
 #include "src/ImGuiManager.h"
+#include "src/inputQueue.h"
 #include "src/playerCharacter.h"
 #include "src/projectileManager.h"
 #include "src/quadTree.h"
+#include "src/rotatedSpriteCache.h"
+#include "src/simulationThread.h"
 #include "src/sprite.h"
+#include "src/spriteRasterizer.h"
 #include "src/spriteSheet.h"
 #include "src/stateStack.h"
 #include "src/steeringBehaviour.h"
 #include "src/timerManager.h"
 #include "src/textSprite.h"
 #include "src/vector2.h"
+#include "src/weaponSystem.h"
+#include "src/workerPool.h"
+
+// Polls SDL and forwards input as timestamped events, the simulation applies them
+// on its next tick. Called in small slices while the main thread waits between
+// frames so input is sampled far more often than once per frame.
+static void PollEvents() {
+	SDL_Event eventType;
+	while (SDL_PollEvent(&eventType)) {
+		ImGui_ImplSDL2_ProcessEvent(&eventType);
+		InputEvent inputEvent;
+		inputEvent.timestamp = SDL_GetPerformanceCounter();
+		switch (eventType.type) {
+			case SDL_QUIT: {
+				runningGame = false;
+				break;
+			}
+			case SDL_RENDER_TARGETS_RESET:
+			case SDL_RENDER_DEVICE_RESET: {
+				gameStateHandler->ResetRenderCache();
+				break;
+			}
+			case SDL_KEYDOWN: {
+				if (eventType.key.repeat) {
+					break;
+				}
+				inputEvent.type = InputEventType::KeyDown;
+				inputEvent.code = eventType.key.keysym.scancode;
+				inputQueue->Push(inputEvent);
+				break;
+			}
+			case SDL_KEYUP: {
+				inputEvent.type = InputEventType::KeyUp;
+				inputEvent.code = eventType.key.keysym.scancode;
+				inputQueue->Push(inputEvent);
+				break;
+			}
+			case SDL_MOUSEBUTTONDOWN: {
+				inputEvent.type = InputEventType::MouseButtonDown;
+				inputEvent.code = eventType.button.button;
+				inputQueue->Push(inputEvent);
+				break;
+			}
+			case SDL_MOUSEBUTTONUP: {
+				inputEvent.type = InputEventType::MouseButtonUp;
+				inputEvent.code = eventType.button.button;
+				inputQueue->Push(inputEvent);
+			}
+		}
+	}
+}
 
 int main(int argc, char* argv[]) {
-	HWND windowHandle = GetConsoleWindow();
-	ShowWindow(windowHandle, SW_HIDE);
+	const bool benchmarkMode = IsBenchmarkRequested(argc, argv);
+	if (benchmarkMode) {
+		SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+	} else {
+#ifdef _WIN32
+		HWND windowHandle = GetConsoleWindow();
+		ShowWindow(windowHandle, SW_HIDE);
+#endif
+	}
 
 	SDL_Init(SDL_INIT_EVERYTHING);
 	TTF_Init();
 	IMG_Init(1);
 
 	window = SDL_CreateWindow("Game", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, windowWidth, windowHeight, 0);	
-	renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+	renderer = SDL_CreateRenderer(window, -1, benchmarkMode ? SDL_RENDERER_SOFTWARE : SDL_RENDERER_ACCELERATED);
 
+	// Created first so every sprite loaded by the managers below ends up in their atlases.
+	spriteRasterizer = std::make_shared<SpriteRasterizer>(windowWidth, windowHeight);
+	rotatedSpriteCache = std::make_shared<RotatedSpriteCache>();
 	enemyManager = std::make_shared<EnemyManager>();
 	gameStateHandler = std::make_shared<GameStateHandler>();
 	debugDrawer = std::make_shared<DebugDrawer>();
 	imGuiHandler = std::make_shared<ImGuiHandler>();
+	inputQueue = std::make_shared<InputQueue>();
+	performanceProfiler = std::make_shared<PerformanceProfiler>();
+	frameSpikeRecorder = std::make_shared<FrameSpikeRecorder>(1000.f / 60.f);
 	projectileManager = std::make_shared<ProjectileManager>();
 	playerCharacter = std::make_shared<PlayerCharacter>("res/sprites/CoralineDadKing.png",
 		0.f, Vector2<float>(windowWidth * 0.5f, windowHeight * 0.5f));
 
 	timerManager = std::make_shared<TimerManager>();
+	weaponSystem = std::make_shared<WeaponSystem>();
+	workerPool = std::make_shared<WorkerPool>(std::thread::hardware_concurrency());
 	separationBehaviour = std::make_shared<SeparationBehaviour>();
+	simulationThread = std::make_shared<SimulationThread>(1.f / 60.f);
 
 	//Init here
 	enemyManager->Init();
@@ -57,85 +134,113 @@ int main(int argc, char* argv[]) {
 
 	gameStateHandler->AddState(std::make_shared<MenuState>());
 
+	if (benchmarkMode) {
+		HeadlessBenchmark benchmark(ParseBenchmarkSettings(argc, argv));
+		benchmark.Run();
+		imGuiHandler->ShutDown();
+		SDL_DestroyWindow(window);
+		SDL_Quit();
+		return 0;
+	}
+
 	std::shared_ptr<TextSprite> fpsText = std::make_shared<TextSprite>();
 	fpsText->Init("res/roboto.ttf", 24, std::to_string(0).c_str(), { 255, 255, 255,255});
 
 	Uint64 previous_ticks = SDL_GetPerformanceCounter();
+	float simulationTime = 0.f;
 	runningGame = true;
 	while (runningGame) {
-		ImGui_ImplSDL2_NewFrame(window);
-		ImGui::NewFrame();
+		performanceProfiler->BeginFrame();
+		imGuiHandler->NewFrame();
 
-		frameNumber++;
 		const Uint64 ticks = SDL_GetPerformanceCounter();
 		const Uint64 delta_ticks = ticks - previous_ticks;
 		previous_ticks = ticks;
-		deltaTime = (float)delta_ticks / (float)SDL_GetPerformanceFrequency();
-
-		SDL_Event eventType;
-		while (SDL_PollEvent(&eventType)) {
-			ImGui_ImplSDL2_ProcessEvent(&eventType);
-			switch (eventType.type) {
-				case SDL_QUIT: {
-					runningGame = false;
-					break;
-				}
-				case SDL_KEYDOWN: {
-					const int scanCode = eventType.key.keysym.scancode;
-					if (eventType.key.repeat) {
-						break;
-					}
-					keys[scanCode].changeFrame = frameNumber;
-					keys[scanCode].state = true;
-					break;
-				}
-				case SDL_KEYUP: {
-					const int scanCode = eventType.key.keysym.scancode;
-					keys[scanCode].changeFrame = frameNumber;
-					keys[scanCode].state = false;
-					break;
-				}
-				case SDL_MOUSEBUTTONDOWN: {
-					if (eventType.key.repeat) {
-						break;
-					}
-					mouseButtons[eventType.button.button].changeFrame = frameNumber;
-					mouseButtons[eventType.button.button].state = true;
-					break;
-				}
-				case SDL_MOUSEBUTTONUP: {
-					mouseButtons[eventType.button.button].changeFrame = frameNumber;
-					mouseButtons[eventType.button.button].state = false;
-				}
-			}
+		const float frameTime = (float)delta_ticks / (float)SDL_GetPerformanceFrequency();
+
+		if (simulationThread->IsRunning() && (!simulationThread->IsEnabled() || gameStateHandler->HasPendingStateChanges())) {
+			simulationThread->Stop();
+		} else if (!simulationThread->IsRunning() && simulationThread->IsEnabled() && gameStateHandler->IsGameStateActive()) {
+			simulationThread->Start();
+			simulationTime = 0.f;
 		}
 
-		//Update here
-		gameStateHandler->UpdateState();
+		PollEvents();
 
-		SDL_SetRenderDrawColor(renderer, 75, 75, 75, 255);
-		SDL_RenderClear(renderer);
+		if (simulationThread->IsRunning()) {
+			simulationThread->AcquireSnapshot();
+			const WorldSnapshot& snapshot = simulationThread->GetSnapshot();
 
-		//Render images here
-		gameStateHandler->RenderState();
+			SDL_SetRenderDrawColor(renderer, 75, 75, 75, 255);
+			SDL_RenderClear(renderer);
 
-		debugDrawer->DrawBoxes();
-		debugDrawer->DrawCircles();
-		debugDrawer->DrawLines();
+			performanceProfiler->BeginPhase(ProfilerPhase::Render);
+			snapshot.Render();
+			performanceProfiler->EndPhase(ProfilerPhase::Render);
 
-		enemyManager->ClearEnemyQuadTree();
-		projectileManager->ClearProjectileQuadTree();
+			performanceProfiler->BeginPhase(ProfilerPhase::DebugDraw);
+			debugDrawer->Draw();
+			performanceProfiler->EndPhase(ProfilerPhase::DebugDraw);
 
-		//Render text here
-		fpsText->ChangeText(std::to_string(1 / deltaTime).c_str(), { 255, 255, 255, 255 });
-		fpsText->Render();
-		gameStateHandler->RenderStateText();
+			fpsText->ChangeText(std::to_string(1 / frameTime).c_str(), { 255, 255, 255, 255 });
+			fpsText->Render();
+			playerCharacter->RenderHealthText(snapshot.playerHealth);
+
+		} else {
+			//Update here, in fixed steps with at most a few per frame so a long frame can't spiral
+			simulationTime = std::min(simulationTime + frameTime, simulationThread->GetFixedDeltaTime() * 4.f);
+			while (simulationTime >= simulationThread->GetFixedDeltaTime()) {
+				simulationThread->Step();
+				simulationTime -= simulationThread->GetFixedDeltaTime();
+			}
 
+			SDL_SetRenderDrawColor(renderer, 75, 75, 75, 255);
+			SDL_RenderClear(renderer);
+
+			//Render images here
+			performanceProfiler->BeginPhase(ProfilerPhase::Render);
+			gameStateHandler->RenderState();
+			performanceProfiler->EndPhase(ProfilerPhase::Render);
+
+			performanceProfiler->BeginPhase(ProfilerPhase::DebugDraw);
+			debugDrawer->Draw();
+			performanceProfiler->EndPhase(ProfilerPhase::DebugDraw);
+
+			//Render text here
+			fpsText->ChangeText(std::to_string(1 / frameTime).c_str(), { 255, 255, 255, 255 });
+			fpsText->Render();
+			gameStateHandler->RenderStateText();
+		}
+
+		performanceProfiler->BeginPhase(ProfilerPhase::ImGui);
+		performanceProfiler->UpdateImgui();
+		imGuiHandler->UpdateImgui();
+		gameStateHandler->UpdateImgui();
+		frameSpikeRecorder->UpdateImgui();
+		enemyManager->UpdateImgui();
+		projectileManager->UpdateImgui();
+		weaponSystem->UpdateImgui();
+		simulationThread->UpdateImgui();
+		inputQueue->UpdateImgui();
+		spriteRasterizer->UpdateImgui();
+		rotatedSpriteCache->UpdateImgui();
 		imGuiHandler->Render();
+		performanceProfiler->EndPhase(ProfilerPhase::ImGui);
 
 		SDL_RenderPresent(renderer);
-		SDL_Delay(16);
+		if (simulationThread->IsRunning()) {
+			simulationThread->RecordPresent();
+		}
+		performanceProfiler->EndFrame();
+		frameSpikeRecorder->RecordFrame();
+
+		const Uint64 delayEnd = SDL_GetPerformanceCounter() + SDL_GetPerformanceFrequency() * 16 / 1000;
+		while (SDL_GetPerformanceCounter() < delayEnd) {
+			SDL_Delay(1);
+			PollEvents();
+		}
 	}
+	simulationThread->Stop();
 	imGuiHandler->ShutDown();
 	SDL_DestroyWindow(window);
 	SDL_Quit();
@@ -0,0 +1,497 @@
+#pragma once
+#include "broadphase.h"
+#include "collision.h"
+#include "vector2.h"
+
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
+#include "debugDrawer.h"
+#include "gameEngine.h"
+
+// Dynamic bounding volume tree. Every leaf stores a box fattened by a margin around its
+// collider, so an object that moves a little keeps its leaf and is only reinserted once
+// it leaves the fat box. Branches are kept balanced with AVL style rotations.
+//
+// Insert adds a leaf for a new object or refits the leaf it already has. Clear ends the
+// frame: leaves that were not inserted since the previous Clear are removed, the rest
+// stay in the tree for the next frame.
+template<typename T>
+class AABBTree : public Broadphase<T> {
+public:
+	AABBTree(float fatMargin);
+	~AABBTree() {}
+
+	bool Insert(T object, Circle circleCollider) override;
+
+	std::vector<T> Query(Circle range) override;
+	void Query(Circle range, std::vector<T>& objectsFound) override;
+	void QueryNearest(Vector2<float> point, unsigned int count, std::vector<BroadphaseHit<T>>& hits) override;
+	void Raycast(Vector2<float> start, Vector2<float> end, std::vector<BroadphaseHit<T>>& hits) override;
+	void QueryCone(const Cone& cone, std::vector<T>& objectsFound) override;
+
+	BroadphaseStatistics GetStatistics() override;
+
+	void Clear() override;
+
+	void Render() override;
+
+	static const int nullNode = -1;
+
+private:
+	struct AABBTreeNode {
+		AABB fatBox;
+		Circle circleCollider;
+		T object = T();
+
+		int parent = nullNode;
+		int left = nullNode;
+		int right = nullNode;
+		int height = 0;
+
+		unsigned int lastInserted = 0;
+
+		bool IsLeaf() const { return left == nullNode; }
+	};
+
+	static AABB Combine(const AABB& boxA, const AABB& boxB);
+	static AABB MakeBox(Vector2<float> min, Vector2<float> max);
+	static float Perimeter(const AABB& box);
+
+	int AllocateNode();
+	void FreeNode(int nodeIndex);
+
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	void Refit(int nodeIndex);
+	int Balance(int nodeIndex);
+
+	void CollectStatistics(int nodeIndex, unsigned int depth, BroadphaseStatistics& statistics);
+
+	std::vector<AABBTreeNode> _nodes;
+	std::unordered_map<T, int> _leaves;
+
+	float _fatMargin = 0.f;
+	float _displacementMultiplier = 4.f;
+
+	int _root = nullNode;
+	int _freeList = nullNode;
+
+	std::atomic<unsigned int> _queryCount = 0;
+	std::atomic<unsigned int> _queryResultCount = 0;
+
+	unsigned int _frame = 0;
+	unsigned int _reinsertCount = 0;
+};
+template<typename T>
+inline AABBTree<T>::AABBTree(float fatMargin) {
+	_fatMargin = fatMargin;
+}
+
+template<typename T>
+inline bool AABBTree<T>::Insert(T object, Circle circleCollider) {
+	const Vector2<float> extent = Vector2<float>(circleCollider.radius + _fatMargin, circleCollider.radius + _fatMargin);
+	auto leafIterator = _leaves.find(object);
+	if (leafIterator == _leaves.end()) {
+		const int leaf = AllocateNode();
+		_nodes[leaf].object = object;
+		_nodes[leaf].circleCollider = circleCollider;
+		_nodes[leaf].fatBox = MakeBox(circleCollider.position - extent, circleCollider.position + extent);
+		_nodes[leaf].lastInserted = _frame;
+		InsertLeaf(leaf);
+		_leaves.emplace(object, leaf);
+		return true;
+	}
+	const int leaf = leafIterator->second;
+	const Vector2<float> displacement = circleCollider.position - _nodes[leaf].circleCollider.position;
+	_nodes[leaf].circleCollider = circleCollider;
+	_nodes[leaf].lastInserted = _frame;
+	if (AABBContainsCircle(_nodes[leaf].fatBox, circleCollider)) {
+		return true;
+	}
+
+	// Stretch the new fat box along the movement since the last insert, most entities
+	// keep their heading for a while so this cuts down on reinserts.
+	Vector2<float> min = circleCollider.position - extent;
+	Vector2<float> max = circleCollider.position + extent;
+	const Vector2<float> predicted = displacement * Vector2<float>(_displacementMultiplier);
+	min.x += std::min(predicted.x, 0.f);
+	min.y += std::min(predicted.y, 0.f);
+	max.x += std::max(predicted.x, 0.f);
+	max.y += std::max(predicted.y, 0.f);
+
+	RemoveLeaf(leaf);
+	_nodes[leaf].fatBox = MakeBox(min, max);
+	InsertLeaf(leaf);
+	_reinsertCount++;
+	return true;
+}
+
+template<typename T>
+inline std::vector<T> AABBTree<T>::Query(Circle range) {
+	std::vector<T> objectsFound;
+	Query(range, objectsFound);
+	return objectsFound;
+}
+template<typename T>
+inline void AABBTree<T>::Query(Circle range, std::vector<T>& objectsFound) {
+	// One stack per thread so queries can run from several threads at once.
+	static thread_local std::vector<int> nodeStack;
+	objectsFound.clear();
+	if (_root != nullNode) {
+		nodeStack.clear();
+		nodeStack.emplace_back(_root);
+		while (!nodeStack.empty()) {
+			AABBTreeNode& node = _nodes[nodeStack.back()];
+			nodeStack.pop_back();
+			if (!AABBCircleIntersect(node.fatBox, range)) {
+				continue;
+			}
+			if (node.IsLeaf()) {
+				// Leaves not inserted this frame belong to removed objects and go away on Clear.
+				if (node.lastInserted == _frame && CircleIntersect(range, node.circleCollider)) {
+					objectsFound.emplace_back(node.object);
+				}
+				continue;
+			}
+			nodeStack.emplace_back(node.left);
+			nodeStack.emplace_back(node.right);
+		}
+	}
+	_queryCount.fetch_add(1, std::memory_order_relaxed);
+	_queryResultCount.fetch_add(objectsFound.size(), std::memory_order_relaxed);
+}
+
+// Best first over the fat boxes, which contain the collider centres of every leaf below them.
+template<typename T>
+inline void AABBTree<T>::QueryNearest(Vector2<float> point, unsigned int count, std::vector<BroadphaseHit<T>>& hits) {
+	struct NodeEntry {
+		float squaredDistance;
+		int nodeIndex;
+	};
+	auto isFurther = [](const NodeEntry& entryA, const NodeEntry& entryB) { return entryA.squaredDistance > entryB.squaredDistance; };
+	static thread_local std::vector<NodeEntry> nodeQueue;
+
+	hits.clear();
+	if (_root != nullNode && count > 0) {
+		nodeQueue.clear();
+		nodeQueue.push_back({ AABBDistanceSquared(_nodes[_root].fatBox, point), _root });
+		while (!nodeQueue.empty()) {
+			std::pop_heap(nodeQueue.begin(), nodeQueue.end(), isFurther);
+			const NodeEntry entry = nodeQueue.back();
+			nodeQueue.pop_back();
+			if (hits.size() == count && entry.squaredDistance >= hits.front().distance) {
+				break;
+			}
+			const AABBTreeNode& node = _nodes[entry.nodeIndex];
+			if (node.IsLeaf()) {
+				if (node.lastInserted == _frame) {
+					PushNearestHit(hits, count, node.object,
+						Vector2<float>::squaredDistanceBetweenVectors(node.circleCollider.position, point));
+				}
+				continue;
+			}
+			const int children[2] = { node.left, node.right };
+			for (int child : children) {
+				const float squaredDistance = AABBDistanceSquared(_nodes[child].fatBox, point);
+				if (hits.size() < count || squaredDistance < hits.front().distance) {
+					nodeQueue.push_back({ squaredDistance, child });
+					std::push_heap(nodeQueue.begin(), nodeQueue.end(), isFurther);
+				}
+			}
+		}
+		SortNearestHits(hits);
+	}
+	_queryCount.fetch_add(1, std::memory_order_relaxed);
+	_queryResultCount.fetch_add(hits.size(), std::memory_order_relaxed);
+}
+
+template<typename T>
+inline void AABBTree<T>::Raycast(Vector2<float> start, Vector2<float> end, std::vector<BroadphaseHit<T>>& hits) {
+	static thread_local std::vector<int> nodeStack;
+	hits.clear();
+	if (_root != nullNode) {
+		const float length = Vector2<float>::distanceBetweenVectors(start, end);
+		float hitFraction = 0.f;
+		nodeStack.clear();
+		nodeStack.emplace_back(_root);
+		while (!nodeStack.empty()) {
+			const AABBTreeNode& node = _nodes[nodeStack.back()];
+			nodeStack.pop_back();
+			if (!SegmentAABBIntersect(node.fatBox, start, end)) {
+				continue;
+			}
+			if (node.IsLeaf()) {
+				if (node.lastInserted == _frame && SegmentCircleIntersect(start, end, node.circleCollider, hitFraction)) {
+					hits.push_back({ node.object, hitFraction * length });
+				}
+				continue;
+			}
+			nodeStack.emplace_back(node.left);
+			nodeStack.emplace_back(node.right);
+		}
+		std::sort(hits.begin(), hits.end(), [](const BroadphaseHit<T>& hitA, const BroadphaseHit<T>& hitB) {
+			return hitA.distance < hitB.distance;
+		});
+	}
+	_queryCount.fetch_add(1, std::memory_order_relaxed);
+	_queryResultCount.fetch_add(hits.size(), std::memory_order_relaxed);
+}
+
+template<typename T>
+inline void AABBTree<T>::QueryCone(const Cone& cone, std::vector<T>& objectsFound) {
+	static thread_local std::vector<int> nodeStack;
+	objectsFound.clear();
+	if (_root != nullNode) {
+		nodeStack.clear();
+		nodeStack.emplace_back(_root);
+		while (!nodeStack.empty()) {
+			const AABBTreeNode& node = _nodes[nodeStack.back()];
+			nodeStack.pop_back();
+			if (!ConeAABBIntersect(cone, node.fatBox)) {
+				continue;
+			}
+			if (node.IsLeaf()) {
+				if (node.lastInserted == _frame && ConeCircleIntersect(cone, node.circleCollider)) {
+					objectsFound.emplace_back(node.object);
+				}
+				continue;
+			}
+			nodeStack.emplace_back(node.left);
+			nodeStack.emplace_back(node.right);
+		}
+	}
+	_queryCount.fetch_add(1, std::memory_order_relaxed);
+	_queryResultCount.fetch_add(objectsFound.size(), std::memory_order_relaxed);
+}
+
+template<typename T>
+inline BroadphaseStatistics AABBTree<T>::GetStatistics() {
+	BroadphaseStatistics statistics;
+	if (_root != nullNode) {
+		CollectStatistics(_root, 0, statistics);
+	}
+	statistics.queryCount = _queryCount.load(std::memory_order_relaxed);
+	statistics.queryResultCount = _queryResultCount.load(std::memory_order_relaxed);
+	statistics.reinsertCount = _reinsertCount;
+	return statistics;
+}
+
+template<typename T>
+inline void AABBTree<T>::Clear() {
+	for (auto leafIterator = _leaves.begin(); leafIterator != _leaves.end();) {
+		if (_nodes[leafIterator->second].lastInserted != _frame) {
+			RemoveLeaf(leafIterator->second);
+			FreeNode(leafIterator->second);
+			leafIterator = _leaves.erase(leafIterator);
+		} else {
+			leafIterator++;
+		}
+	}
+	_frame++;
+	_queryCount.store(0, std::memory_order_relaxed);
+	_queryResultCount.store(0, std::memory_order_relaxed);
+	_reinsertCount = 0;
+}
+
+template<typename T>
+inline void AABBTree<T>::Render() {
+	for (unsigned int i = 0; i < _nodes.size(); i++) {
+		if (_nodes[i].height < 0) {
+			continue;
+		}
+		std::array<int, 4> color = { 0, 200, 255, 255 };
+		if (_nodes[i].IsLeaf()) {
+			color = { 255, 125, 0, 255 };
+		}
+		debugDrawer->AddDebugBox(_nodes[i].fatBox.position, _nodes[i].fatBox.min, _nodes[i].fatBox.max, color);
+	}
+}
+
+template<typename T>
+inline AABB AABBTree<T>::Combine(const AABB& boxA, const AABB& boxB) {
+	return MakeBox(
+		Vector2<float>(std::min(boxA.min.x, boxB.min.x), std::min(boxA.min.y, boxB.min.y)),
+		Vector2<float>(std::max(boxA.max.x, boxB.max.x), std::max(boxA.max.y, boxB.max.y)));
+}
+
+template<typename T>
+inline AABB AABBTree<T>::MakeBox(Vector2<float> min, Vector2<float> max) {
+	return AABB::makeFromPositionSize((min + max) * 0.5f, max.y - min.y, max.x - min.x);
+}
+
+template<typename T>
+inline float AABBTree<T>::Perimeter(const AABB& box) {
+	return 2.f * (box.width + box.height);
+}
+
+template<typename T>
+inline int AABBTree<T>::AllocateNode() {
+	if (_freeList == nullNode) {
+		_nodes.emplace_back();
+		return (int)_nodes.size() - 1;
+	}
+	const int nodeIndex = _freeList;
+	_freeList = _nodes[nodeIndex].parent;
+	_nodes[nodeIndex] = AABBTreeNode();
+	return nodeIndex;
+}
+
+template<typename T>
+inline void AABBTree<T>::FreeNode(int nodeIndex) {
+	// Free nodes are chained through their parent index, height -1 marks them unused.
+	_nodes[nodeIndex] = AABBTreeNode();
+	_nodes[nodeIndex].parent = _freeList;
+	_nodes[nodeIndex].height = -1;
+	_freeList = nodeIndex;
+}
+
+template<typename T>
+inline void AABBTree<T>::InsertLeaf(int leaf) {
+	if (_root == nullNode) {
+		_root = leaf;
+		_nodes[leaf].parent = nullNode;
+		return;
+	}
+
+	// Walk down towards the sibling that grows the total perimeter the least.
+	const AABB leafBox = _nodes[leaf].fatBox;
+	int nodeIndex = _root;
+	while (!_nodes[nodeIndex].IsLeaf()) {
+		const AABBTreeNode& node = _nodes[nodeIndex];
+		const float combinedPerimeter = Perimeter(Combine(node.fatBox, leafBox));
+
+		const float siblingCost = 2.f * combinedPerimeter;
+		const float inheritanceCost = 2.f * (combinedPerimeter - Perimeter(node.fatBox));
+
+		float childCosts[2] = {};
+		const int children[2] = { node.left, node.right };
+		for (unsigned int i = 0; i < 2; i++) {
+			const AABBTreeNode& child = _nodes[children[i]];
+			childCosts[i] = Perimeter(Combine(child.fatBox, leafBox)) + inheritanceCost;
+			if (!child.IsLeaf()) {
+				childCosts[i] -= Perimeter(child.fatBox);
+			}
+		}
+		if (siblingCost < childCosts[0] && siblingCost < childCosts[1]) {
+			break;
+		}
+		nodeIndex = childCosts[0] < childCosts[1] ? children[0] : children[1];
+	}
+
+	const int sibling = nodeIndex;
+	const int oldParent = _nodes[sibling].parent;
+	const int newParent = AllocateNode();
+	_nodes[newParent].parent = oldParent;
+	_nodes[newParent].fatBox = Combine(leafBox, _nodes[sibling].fatBox);
+	_nodes[newParent].height = _nodes[sibling].height + 1;
+	_nodes[newParent].left = sibling;
+	_nodes[newParent].right = leaf;
+	_nodes[sibling].parent = newParent;
+	_nodes[leaf].parent = newParent;
+
+	if (oldParent == nullNode) {
+		_root = newParent;
+	} else if (_nodes[oldParent].left == sibling) {
+		_nodes[oldParent].left = newParent;
+	} else {
+		_nodes[oldParent].right = newParent;
+	}
+	Refit(_nodes[leaf].parent);
+}
+
+template<typename T>
+inline void AABBTree<T>::RemoveLeaf(int leaf) {
+	if (leaf == _root) {
+		_root = nullNode;
+		return;
+	}
+	const int parent = _nodes[leaf].parent;
+	const int grandParent = _nodes[parent].parent;
+	const int sibling = _nodes[parent].left == leaf ? _nodes[parent].right : _nodes[parent].left;
+
+	if (grandParent == nullNode) {
+		_root = sibling;
+		_nodes[sibling].parent = nullNode;
+		FreeNode(parent);
+		return;
+	}
+	if (_nodes[grandParent].left == parent) {
+		_nodes[grandParent].left = sibling;
+	} else {
+		_nodes[grandParent].right = sibling;
+	}
+	_nodes[sibling].parent = grandParent;
+	FreeNode(parent);
+	Refit(grandParent);
+}
+
+template<typename T>
+inline void AABBTree<T>::Refit(int nodeIndex) {
+	while (nodeIndex != nullNode) {
+		nodeIndex = Balance(nodeIndex);
+		AABBTreeNode& node = _nodes[nodeIndex];
+		node.height = 1 + std::max(_nodes[node.left].height, _nodes[node.right].height);
+		node.fatBox = Combine(_nodes[node.left].fatBox, _nodes[node.right].fatBox);
+		nodeIndex = node.parent;
+	}
+}
+
+template<typename T>
+inline int AABBTree<T>::Balance(int nodeIndex) {
+	const int a = nodeIndex;
+	if (_nodes[a].IsLeaf() || _nodes[a].height < 2) {
+		return a;
+	}
+	const int b = _nodes[a].left;
+	const int c = _nodes[a].right;
+	const int balance = _nodes[c].height - _nodes[b].height;
+
+	// Rotates the taller child up into the place of a. The taller grandchild stays
+	// under the promoted node and the shorter one moves under a.
+	if (balance > 1 || balance < -1) {
+		const int promoted = balance > 1 ? c : b;
+		const int kept = balance > 1 ? b : c;
+		const int tallGrandChild = _nodes[_nodes[promoted].left].height > _nodes[_nodes[promoted].right].height ?
+			_nodes[promoted].left : _nodes[promoted].right;
+		const int shortGrandChild = tallGrandChild == _nodes[promoted].left ?
+			_nodes[promoted].right : _nodes[promoted].left;
+
+		_nodes[promoted].parent = _nodes[a].parent;
+		_nodes[a].parent = promoted;
+		if (_nodes[promoted].parent == nullNode) {
+			_root = promoted;
+		} else if (_nodes[_nodes[promoted].parent].left == a) {
+			_nodes[_nodes[promoted].parent].left = promoted;
+		} else {
+			_nodes[_nodes[promoted].parent].right = promoted;
+		}
+
+		_nodes[promoted].left = a;
+		_nodes[promoted].right = tallGrandChild;
+		_nodes[a].left = kept;
+		_nodes[a].right = shortGrandChild;
+		_nodes[shortGrandChild].parent = a;
+
+		_nodes[a].fatBox = Combine(_nodes[kept].fatBox, _nodes[shortGrandChild].fatBox);
+		_nodes[a].height = 1 + std::max(_nodes[kept].height, _nodes[shortGrandChild].height);
+		_nodes[promoted].fatBox = Combine(_nodes[a].fatBox, _nodes[tallGrandChild].fatBox);
+		_nodes[promoted].height = 1 + std::max(_nodes[a].height, _nodes[tallGrandChild].height);
+		return promoted;
+	}
+	return a;
+}
+
+template<typename T>
+inline void AABBTree<T>::CollectStatistics(int nodeIndex, unsigned int depth, BroadphaseStatistics& statistics) {
+	statistics.nodeCount++;
+	if (_nodes[nodeIndex].IsLeaf()) {
+		statistics.objectCount++;
+		statistics.depthHistogram[std::min<unsigned int>(depth, statistics.depthHistogram.size() - 1)]++;
+		return;
+	}
+	CollectStatistics(_nodes[nodeIndex].left, depth + 1, statistics);
+	CollectStatistics(_nodes[nodeIndex].right, depth + 1, statistics);
+}
@@ -0,0 +1,1179 @@
+#include "benchmark.h"
+
+#include "aabbTree.h"
+#include "dataStructuresAndMethods.h"
+#include "debugDrawer.h"
+#include "enemyBase.h"
+#include "enemyManager.h"
+#include "fastTrig.h"
+#include "frameSpikeRecorder.h"
+#include "gameEngine.h"
+#include "imGuiManager.h"
+#include "inputQueue.h"
+#include "playerCharacter.h"
+#include "projectile.h"
+#include "projectileManager.h"
+#include "quadTree.h"
+#include "rotatedSpriteCache.h"
+#include "simulationThread.h"
+#include "sprite.h"
+#include "spriteRasterizer.h"
+#include "stateStack.h"
+#include "vector2Batch.h"
+#include "weaponSystem.h"
+#include "workerPool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <thread>
+
+static float MillisecondsSince(Uint64 start) {
+	return (float)(SDL_GetPerformanceCounter() - start) * 1000.f / (float)SDL_GetPerformanceFrequency();
+}
+
+static std::vector<Circle> CreateRandomCircles(unsigned int count, float margin, float minRadius, float maxRadius,
+	std::mt19937& engine) {
+	std::uniform_real_distribution<float> distX{ -margin, windowWidth + margin };
+	std::uniform_real_distribution<float> distY{ -margin, windowHeight + margin };
+	std::uniform_real_distribution<float> distRadius{ minRadius, maxRadius };
+	std::vector<Circle> circles(count);
+	for (unsigned int i = 0; i < count; i++) {
+		circles[i].position = { distX(engine), distY(engine) };
+		circles[i].radius = distRadius(engine);
+	}
+	return circles;
+}
+
+// Same statistics and the same query results in the same order means the same tree.
+static bool IsSameQuadTree(QuadTree<unsigned int>& quadTreeA, QuadTree<unsigned int>& quadTreeB, const std::vector<Circle>& queries) {
+	const BroadphaseStatistics statisticsA = quadTreeA.GetStatistics();
+	const BroadphaseStatistics statisticsB = quadTreeB.GetStatistics();
+	if (statisticsA.nodeCount != statisticsB.nodeCount || statisticsA.objectCount != statisticsB.objectCount ||
+		statisticsA.overflowCount != statisticsB.overflowCount || statisticsA.depthHistogram != statisticsB.depthHistogram) {
+		return false;
+	}
+	for (unsigned int i = 0; i < queries.size(); i++) {
+		if (quadTreeA.Query(queries[i]) != quadTreeB.Query(queries[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool IsBenchmarkRequested(int argc, char* argv[]) {
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--benchmark") == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+BenchmarkSettings ParseBenchmarkSettings(int argc, char* argv[]) {
+	BenchmarkSettings settings;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--scenario") == 0 && i + 1 < argc) {
+			i++;
+			if (std::strcmp(argv[i], "quadtree") == 0) {
+				settings.scenario = BenchmarkScenario::QuadTree;
+			} else if (std::strcmp(argv[i], "broadphase") == 0) {
+				settings.scenario = BenchmarkScenario::Broadphase;
+			} else if (std::strcmp(argv[i], "vector") == 0) {
+				settings.scenario = BenchmarkScenario::VectorMath;
+			} else if (std::strcmp(argv[i], "trig") == 0) {
+				settings.scenario = BenchmarkScenario::Trig;
+			} else if (std::strcmp(argv[i], "pipeline") == 0) {
+				settings.scenario = BenchmarkScenario::Pipeline;
+			} else if (std::strcmp(argv[i], "parallelbuild") == 0) {
+				settings.scenario = BenchmarkScenario::ParallelBuild;
+			} else if (std::strcmp(argv[i], "spatialsort") == 0) {
+				settings.scenario = BenchmarkScenario::SpatialSort;
+			} else if (std::strcmp(argv[i], "attack") == 0) {
+				settings.scenario = BenchmarkScenario::Attack;
+			} else if (std::strcmp(argv[i], "emitter") == 0) {
+				settings.scenario = BenchmarkScenario::Emitter;
+			} else if (std::strcmp(argv[i], "queries") == 0) {
+				settings.scenario = BenchmarkScenario::SpatialQuery;
+			} else if (std::strcmp(argv[i], "raster") == 0) {
+				settings.scenario = BenchmarkScenario::Raster;
+			} else if (std::strcmp(argv[i], "rotation") == 0) {
+				settings.scenario = BenchmarkScenario::Rotation;
+			} else if (std::strcmp(argv[i], "pause") == 0) {
+				settings.scenario = BenchmarkScenario::Pause;
+			} else if (std::strcmp(argv[i], "debugdraw") == 0) {
+				settings.scenario = BenchmarkScenario::DebugDraw;
+			} else if (std::strcmp(argv[i], "imgui") == 0) {
+				settings.scenario = BenchmarkScenario::ImGui;
+			}
+		} else if (std::strcmp(argv[i], "--broadphase") == 0 && i + 1 < argc) {
+			i++;
+			for (unsigned int k = 0; k < (unsigned int)BroadphaseType::Count; k++) {
+				if (std::strcmp(argv[i], GetBroadphaseName((BroadphaseType)k)) == 0) {
+					settings.broadphaseType = (BroadphaseType)k;
+				}
+			}
+		} else if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+			settings.ticks = std::atoi(argv[++i]);
+		} else if (std::strcmp(argv[i], "--spike-budget") == 0 && i + 1 < argc) {
+			settings.spikeBudget = (float)std::atof(argv[++i]);
+		} else if (std::strcmp(argv[i], "--render") == 0) {
+			settings.renderFrames = true;
+		} else if (std::strcmp(argv[i], "--no-counters") == 0) {
+			settings.hardwareCounters = false;
+		} else if (std::strcmp(argv[i], "--no-lod") == 0) {
+			settings.levelOfDetail = false;
+		} else if (std::strcmp(argv[i], "--no-fire") == 0) {
+			settings.playerFiring = false;
+		} else if (std::strcmp(argv[i], "--no-spatial-sort") == 0) {
+			settings.spatialSort = false;
+		}
+	}
+	return settings;
+}
+
+HeadlessBenchmark::HeadlessBenchmark(BenchmarkSettings settings) : _settings(settings) {
+	_tickTimes.reserve(_settings.ticks);
+}
+
+void HeadlessBenchmark::Run() {
+	switch (_settings.scenario) {
+	case BenchmarkScenario::QuadTree:
+		RunQuadTreeBenchmark();
+		break;
+
+	case BenchmarkScenario::Broadphase:
+		RunBroadphaseBenchmark();
+		break;
+
+	case BenchmarkScenario::VectorMath:
+		RunVectorMathBenchmark();
+		break;
+
+	case BenchmarkScenario::Trig:
+		RunTrigBenchmark();
+		break;
+
+	case BenchmarkScenario::Pipeline:
+		RunPipelineBenchmark();
+		break;
+
+	case BenchmarkScenario::ParallelBuild:
+		RunParallelBuildBenchmark();
+		break;
+
+	case BenchmarkScenario::SpatialSort:
+		RunSpatialSortBenchmark();
+		break;
+
+	case BenchmarkScenario::Attack:
+		RunAttackBenchmark();
+		break;
+
+	case BenchmarkScenario::Emitter:
+		RunEmitterBenchmark();
+		break;
+
+	case BenchmarkScenario::SpatialQuery:
+		RunSpatialQueryBenchmark();
+		break;
+
+	case BenchmarkScenario::Raster:
+		RunRasterBenchmark();
+		break;
+
+	case BenchmarkScenario::Rotation:
+		RunRotationBenchmark();
+		break;
+
+	case BenchmarkScenario::Pause:
+		RunPauseBenchmark();
+		break;
+
+	case BenchmarkScenario::DebugDraw:
+		RunDebugDrawBenchmark();
+		break;
+
+	case BenchmarkScenario::ImGui:
+		RunImGuiBenchmark();
+		break;
+
+	default:
+		RunSimulation();
+		break;
+	}
+}
+
+void HeadlessBenchmark::RunSimulation() {
+	if (_settings.hardwareCounters && !performanceProfiler->EnableHardwareCounters()) {
+		printf("Hardware counters unavailable, reporting wall-clock timings only\n");
+	}
+	frameSpikeRecorder->SetFrameBudget(_settings.spikeBudget);
+	enemyManager->SetLevelOfDetailEnabled(_settings.levelOfDetail);
+	enemyManager->SetSpatialSortEnabled(_settings.spatialSort);
+	projectileManager->SetSpatialSortEnabled(_settings.spatialSort);
+	enemyManager->SetBroadphaseType(_settings.broadphaseType);
+	projectileManager->SetBroadphaseType(_settings.broadphaseType);
+
+	// Same seed on every run so spawn positions and weapon picks repeat between runs.
+	randomEngine.seed(1234);
+	gameStateHandler->BackToFirstState();
+	gameStateHandler->AddState(std::make_shared<GameState>());
+
+	for (unsigned int i = 0; i < _settings.ticks; i++) {
+		RunTick();
+	}
+	PrintResults();
+}
+
+void HeadlessBenchmark::RunTick() {
+	performanceProfiler->BeginFrame();
+	frameNumber++;
+	deltaTime = _settings.fixedDeltaTime;
+	mouseButtons[SDL_BUTTON_LEFT].state = _settings.playerFiring;
+
+	gameStateHandler->UpdateState();
+	if (playerCharacter->GetCurrentHealth() <= 0) {
+		gameStateHandler->ReplaceCurrentState(std::make_shared<GameState>());
+		_playerDeaths++;
+	}
+
+	if (_settings.renderFrames) {
+		performanceProfiler->BeginPhase(ProfilerPhase::Render);
+		SDL_SetRenderDrawColor(renderer, 75, 75, 75, 255);
+		SDL_RenderClear(renderer);
+		gameStateHandler->RenderState();
+		SDL_RenderPresent(renderer);
+		performanceProfiler->EndPhase(ProfilerPhase::Render);
+	}
+
+	performanceProfiler->CaptureFrameStatistics();
+	enemyManager->SyncImgui();
+	projectileManager->SyncImgui();
+	weaponSystem->SyncImgui();
+	for (unsigned int i = 0; i < (unsigned int)EnemyType::Count; i++) {
+		_entityTicks += enemyManager->GetActiveEnemyCount((EnemyType)i);
+	}
+	for (unsigned int i = 0; i < (unsigned int)ProjectileType::Count; i++) {
+		_entityTicks += projectileManager->GetActiveProjectileCount((ProjectileType)i);
+	}
+	_levelOfDetailTimeSaved += enemyManager->GetLevelOfDetailTimeSaved();
+	_skippedUpdates += enemyManager->GetSkippedUpdates();
+	const BroadphaseStatistics projectileStatistics = performanceProfiler->GetProjectileBroadphaseStatistics();
+	_maskedResults += projectileStatistics.maskedResultCount;
+	_unmaskedResults += projectileStatistics.unmaskedResultCount;
+	enemyManager->ClearEnemyQuadTree();
+	projectileManager->ClearProjectileQuadTree();
+
+	performanceProfiler->EndFrame();
+	frameSpikeRecorder->RecordFrame();
+
+	_tickTimes.emplace_back(performanceProfiler->GetFrameTime());
+	for (unsigned int i = 0; i < (unsigned int)ProfilerPhase::Count; i++) {
+		_phaseTotals[i] += performanceProfiler->GetPhaseTime((ProfilerPhase)i);
+		if (performanceProfiler->HardwareCountersEnabled()) {
+			_phaseCounters[i].Add(HardwareCounterSample(), performanceProfiler->GetPhaseCounters((ProfilerPhase)i));
+		}
+	}
+}
+
+void HeadlessBenchmark::PrintResults() {
+	if (_tickTimes.empty()) {
+		return;
+	}
+	std::sort(_tickTimes.begin(), _tickTimes.end());
+	const double entitiesPerTick = _entityTicks / _tickTimes.size();
+
+	printf("Ticks: %zu  entities/tick: %.1f  player deaths: %u  spikes captured: %u\n", _tickTimes.size(),
+		entitiesPerTick, _playerDeaths, frameSpikeRecorder->GetSpikesCaptured());
+	printf("Tick ms  p50 %.3f  p95 %.3f  p99 %.3f  max %.3f\n",
+		_tickTimes[_tickTimes.size() / 2],
+		_tickTimes[(size_t)(_tickTimes.size() * 0.95)],
+		_tickTimes[(size_t)(_tickTimes.size() * 0.99)],
+		_tickTimes.back());
+
+	printf("Broadphase %s  spatial sort %s\n", GetBroadphaseName(_settings.broadphaseType), _settings.spatialSort ? "on" : "off");
+	printf("Enemy LOD  skipped updates/tick %.1f  estimated ms saved/tick %.4f\n",
+		_skippedUpdates / _tickTimes.size(), _levelOfDetailTimeSaved / _tickTimes.size());
+	printf("Projectile query results/tick  masked %.1f  all layers %.1f\n",
+		_maskedResults / _tickTimes.size(), _unmaskedResults / _tickTimes.size());
+
+	printf("%-18s %10s", "Phase", "avg ms");
+	if (performanceProfiler->HardwareCountersEnabled()) {
+		printf(" %8s %14s %14s %14s", "IPC", "L1D/entity", "LLC/entity", "BrMiss/entity");
+	}
+	printf("\n");
+
+	for (unsigned int i = 0; i < (unsigned int)ProfilerPhase::Count; i++) {
+		printf("%-18s %10.4f", GetProfilerPhaseName((ProfilerPhase)i), _phaseTotals[i] / _tickTimes.size());
+		if (performanceProfiler->HardwareCountersEnabled()) {
+			const double entityTicks = std::max(_entityTicks, 1.0);
+			printf(" %8.3f %14.3f %14.3f %14.3f", _phaseCounters[i].GetInstructionsPerCycle(),
+				_phaseCounters[i].GetValue(HardwareCounter::L1DataMisses) / entityTicks,
+				_phaseCounters[i].GetValue(HardwareCounter::LastLevelCacheMisses) / entityTicks,
+				_phaseCounters[i].GetValue(HardwareCounter::BranchMisses) / entityTicks);
+		}
+		printf("\n");
+	}
+}
+
+void HeadlessBenchmark::ResetResults() {
+	_phaseTotals.fill(0.0);
+	for (unsigned int i = 0; i < _phaseCounters.size(); i++) {
+		_phaseCounters[i].Reset();
+	}
+	_tickTimes.clear();
+	_entityTicks = 0.0;
+	_levelOfDetailTimeSaved = 0.0;
+	_skippedUpdates = 0.0;
+	_maskedResults = 0.0;
+	_unmaskedResults = 0.0;
+	_playerDeaths = 0;
+}
+
+void HeadlessBenchmark::RunQuadTreeBenchmark() {
+	std::mt19937 engine(1234);
+	const unsigned int entityCounts[] = { 1000, 10000 };
+	const float loosenessValues[] = { 1.f, 1.5f, 2.f };
+	const unsigned int queryCount = 2000;
+
+	printf("%-8s %-9s %10s %10s %10s %10s %10s\n", "Entities", "Loose", "Build ms", "Query ms", "Brute ms", "Missed", "Overflow");
+	for (unsigned int entityCount : entityCounts) {
+		// Entities spill slightly outside the window, the same way enemies spawn on the edges.
+		std::vector<Circle> colliders = CreateRandomCircles(entityCount, 50.f, 8.f, 16.f, engine);
+		std::vector<Circle> queries = CreateRandomCircles(queryCount, 0.f, 16.f, 64.f, engine);
+
+		Uint64 start = SDL_GetPerformanceCounter();
+		std::vector<std::vector<unsigned int>> expected(queryCount);
+		for (unsigned int q = 0; q < queryCount; q++) {
+			for (unsigned int i = 0; i < entityCount; i++) {
+				if (CircleIntersect(queries[q], colliders[i])) {
+					expected[q].emplace_back(i);
+				}
+			}
+		}
+		const float bruteForceTime = MillisecondsSince(start);
+
+		for (float looseness : loosenessValues) {
+			QuadTreeNode quadTreeNode;
+			quadTreeNode.rectangle = AABB::makeFromPositionSize(
+				Vector2<float>(windowWidth * 0.5f, windowHeight * 0.5f), windowHeight, windowWidth);
+			QuadTree<unsigned int> quadTree(quadTreeNode, 25, looseness);
+
+			start = SDL_GetPerformanceCounter();
+			for (unsigned int i = 0; i < entityCount; i++) {
+				quadTree.Insert(i, colliders[i]);
+			}
+			const float buildTime = MillisecondsSince(start);
+
+			unsigned int missed = 0;
+			float queryTime = 0.f;
+			for (unsigned int q = 0; q < queryCount; q++) {
+				start = SDL_GetPerformanceCounter();
+				std::vector<unsigned int> found = quadTree.Query(queries[q]);
+				queryTime += MillisecondsSince(start);
+
+				std::sort(found.begin(), found.end());
+				for (unsigned int i = 0; i < expected[q].size(); i++) {
+					if (!std::binary_search(found.begin(), found.end(), expected[q][i])) {
+						missed++;
+					}
+				}
+			}
+			printf("%-8u %-9.1f %10.3f %10.3f %10.3f %10u %10u\n", entityCount, looseness, buildTime, queryTime,
+				bruteForceTime, missed, quadTree.GetStatistics().overflowCount);
+		}
+	}
+}
+
+void HeadlessBenchmark::RunBroadphaseBenchmark() {
+	// Runs the full simulation once per broadphase, so every structure sees the
+	// movement and query pattern of real gameplay instead of random points.
+	for (unsigned int i = 0; i < (unsigned int)BroadphaseType::Count; i++) {
+		_settings.broadphaseType = (BroadphaseType)i;
+		ResetResults();
+		RunSimulation();
+		printf("\n");
+	}
+}
+
+void HeadlessBenchmark::RunVectorMathBenchmark() {
+	std::mt19937 engine(1234);
+	std::uniform_real_distribution<float> dist{ -500.f, 500.f };
+	const unsigned int vectorCount = 100000;
+	const unsigned int repeats = 100;
+
+	std::vector<Vector2<float>> vectorsA(vectorCount);
+	std::vector<Vector2<float>> vectorsB(vectorCount);
+	std::vector<Vector2<float>> result(vectorCount);
+	for (unsigned int i = 0; i < vectorCount; i++) {
+		vectorsA[i] = { dist(engine), dist(engine) };
+		vectorsB[i] = { dist(engine), dist(engine) };
+	}
+
+	// The checksum keeps the compiler from dropping the loops.
+	double checksum = 0.0;
+	printf("%-28s %10s\n", "Operation (100k vectors)", "ms");
+
+	Uint64 start = SDL_GetPerformanceCounter();
+	for (unsigned int r = 0; r < repeats; r++) {
+		for (unsigned int i = 0; i < vectorCount; i++) {
+			result[i] = vectorsA[i] + vectorsB[i];
+		}
+		checksum += result[r].x;
+	}
+	printf("%-28s %10.4f\n", "operator+", MillisecondsSince(start) / repeats);
+
+	start = SDL_GetPerformanceCounter();
+	for (unsigned int r = 0; r < repeats; r++) {
+		AddVectors(vectorsA, vectorsB, result);
+		checksum += result[r].x;
+	}
+	printf("%-28s %10.4f\n", "AddVectors", MillisecondsSince(start) / repeats);
+
+	start = SDL_GetPerformanceCounter();
+	for (unsigned int r = 0; r < repeats; r++) {
+		for (unsigned int i = 0; i < vectorCount; i++) {
+			result[i] = vectorsA[i].normalized();
+		}
+		checksum += result[r].x;
+	}
+	printf("%-28s %10.4f\n", "normalized", MillisecondsSince(start) / repeats);
+
+	start = SDL_GetPerformanceCounter();
+	for (unsigned int r = 0; r < repeats; r++) {
+		for (unsigned int i = 0; i < vectorCount; i++) {
+			result[i] = vectorsA[i].fastNormalized();
+		}
+		checksum += result[r].x;
+	}
+	printf("%-28s %10.4f\n", "fastNormalized", MillisecondsSince(start) / repeats);
+
+	float normalizeError = 0.f;
+	start = SDL_GetPerformanceCounter();
+	for (unsigned int r = 0; r < repeats; r++) {
+		result = vectorsA;
+		NormalizeVectors(result);
+		checksum += result[r].x;
+	}
+	printf("%-28s %10.4f\n", "NormalizeVectors (+copy)", MillisecondsSince(start) / repeats);
+	for (unsigned int i = 0; i < vectorCount; i++) {
+		normalizeError = std::max(normalizeError, std::abs(result[i].absolute() - 1.f));
+	}
+
+	unsigned int inRange = 0;
+	start = SDL_GetPerformanceCounter();
+	for (unsigned int r = 0; r < repeats; r++) {
+		for (unsigned int i = 0; i < vectorCount; i++) {
+			inRange += Vector2<float>::distanceBetweenVectors(vectorsA[i], vectorsB[i]) <= 300.f;
+		}
+	}
+	printf("%-28s %10.4f\n", "distance <= range", MillisecondsSince(start) / repeats);
+
+	start = SDL_GetPerformanceCounter();
+	for (unsigned int r = 0; r < repeats; r++) {
+		for (unsigned int i = 0; i < vectorCount; i++) {
+			inRange += Vector2<float>::isWithinDistance(vectorsA[i], vectorsB[i], 300.f);
+		}
+	}
+	printf("%-28s %10.4f\n", "isWithinDistance", MillisecondsSince(start) / repeats);
+
+	printf("Max length error after NormalizeVectors: %g\n", normalizeError);
+	printf("Checksum %f %u\n", checksum, inRange);
+}
+
+void HeadlessBenchmark::RunTrigBenchmark() {
+	std::mt19937 engine(1234);
+	std::uniform_real_distribution<float> distPosition{ -1000.f, 1000.f };
+	std::uniform_real_distribution<float> distAngle{ -(float)PI, (float)PI };
+	const unsigned int valueCount = 100000;
+	const unsigned int repeats = 20;
+
+	std::vector<float> valuesX(valueCount);
+	std::vector<float> valuesY(valueCount);
+	std::vector<float> angles(valueCount);
+	std::vector<float> results(valueCount);
+	std::vector<float> sines(valueCount);
+	std::vector<float> cosines(valueCount);
+	for (unsigned int i = 0; i < valueCount; i++) {
+		valuesX[i] = distPosition(engine);
+		valuesY[i] = distPosition(engine);
+		angles[i] = distAngle(engine);
+	}
+
+	double atan2Error = 0.0;
+	double sinCosError = 0.0;
+	for (unsigned int i = 0; i < valueCount; i++) {
+		atan2Error = std::max(atan2Error,
+			std::abs(FastAtan2(valuesY[i], valuesX[i]) - std::atan2((double)valuesY[i], (double)valuesX[i])));
+		float sine;
+		float cosine;
+		FastSinCos(angles[i], sine, cosine);
+		sinCosError = std::max(sinCosError, std::max(std::abs(sine - std::sin((double)angles[i])),
+			std::abs(cosine - std::cos((double)angles[i]))));
+	}
+
+	// The checksum keeps the compiler from dropping the loops.
+	double checksum = 0.0;
+	printf("%-28s %10s\n", "Operation (100k values)", "ms");
+
+	Uint64 start = SDL_GetPerformanceCounter();
+	for (unsigned int r = 0; r < repeats; r++) {
+		for (unsigned int i = 0; i < valueCount; i++) {
+			results[i] = atan2f(valuesY[i], valuesX[i]);
+		}
+		checksum += results[r];
+	}
+	printf("%-28s %10.4f\n", "atan2f", MillisecondsSince(start) / repeats);
+
+	start = SDL_GetPerformanceCounter();
+	for (unsigned int r = 0; r < repeats; r++) {
+		for (unsigned int i = 0; i < valueCount; i++) {
+			results[i] = FastAtan2(valuesY[i], valuesX[i]);
+		}
+		checksum += results[r];
+	}
+	printf("%-28s %10.4f\n", "FastAtan2", MillisecondsSince(start) / repeats);
+
+	start = SDL_GetPerformanceCounter();
+	for (unsigned int r = 0; r < repeats; r++) {
+		FastAtan2Batch(valuesY.data(), valuesX.data(), results.data(), valueCount);
+		checksum += results[r];
+	}
+	printf("%-28s %10.4f\n", "FastAtan2Batch", MillisecondsSince(start) / repeats);
+
+	start = SDL_GetPerformanceCounter();
+	for (unsigned int r = 0; r < repeats; r++) {
+		for (unsigned int i = 0; i < valueCount; i++) {
+			sines[i] = sinf(angles[i]);
+			cosines[i] = cosf(angles[i]);
+		}
+		checksum += sines[r] + cosines[r];
+	}
+	printf("%-28s %10.4f\n", "sinf + cosf", MillisecondsSince(start) / repeats);
+
+	start = SDL_GetPerformanceCounter();
+	for (unsigned int r = 0; r < repeats; r++) {
+		for (unsigned int i = 0; i < valueCount; i++) {
+			FastSinCos(angles[i], sines[i], cosines[i]);
+		}
+		checksum += sines[r] + cosines[r];
+	}
+	printf("%-28s %10.4f\n", "FastSinCos", MillisecondsSince(start) / repeats);
+
+	start = SDL_GetPerformanceCounter();
+	for (unsigned int r = 0; r < repeats; r++) {
+		FastSinCosBatch(angles.data(), sines.data(), cosines.data(), valueCount);
+		checksum += sines[r] + cosines[r];
+	}
+	printf("%-28s %10.4f\n", "FastSinCosBatch", MillisecondsSince(start) / repeats);
+
+#ifdef FAST_TRIG_USE_LIBM
+	printf("FAST_TRIG_USE_LIBM is defined, the fast functions call the C library\n");
+#endif
+	printf("Max error  atan2 %g rad  sincos %g\n", atan2Error, sinCosError);
+	printf("Checksum %f\n", checksum);
+}
+
+// Compares update and render back to back on one thread against the simulation
+// thread publishing snapshots while the main thread renders the latest one.
+// Both modes render every frame through the software renderer.
+void HeadlessBenchmark::RunPipelineBenchmark() {
+	enemyManager->SetLevelOfDetailEnabled(_settings.levelOfDetail);
+	enemyManager->SetBroadphaseType(_settings.broadphaseType);
+	projectileManager->SetBroadphaseType(_settings.broadphaseType);
+	mouseButtons[SDL_BUTTON_LEFT].state = _settings.playerFiring;
+
+	randomEngine.seed(1234);
+	gameStateHandler->BackToFirstState();
+	gameStateHandler->AddState(std::make_shared<GameState>());
+
+	double sequentialLatency = 0.0;
+	Uint64 start = SDL_GetPerformanceCounter();
+	for (unsigned int i = 0; i < _settings.ticks; i++) {
+		frameNumber++;
+		deltaTime = _settings.fixedDeltaTime;
+		gameStateHandler->UpdateState();
+		if (playerCharacter->GetCurrentHealth() <= 0) {
+			gameStateHandler->ReplaceCurrentState(std::make_shared<GameState>());
+		}
+		const Uint64 updateEnd = SDL_GetPerformanceCounter();
+
+		SDL_SetRenderDrawColor(renderer, 75, 75, 75, 255);
+		SDL_RenderClear(renderer);
+		gameStateHandler->RenderState();
+		SDL_RenderPresent(renderer);
+		sequentialLatency += MillisecondsSince(updateEnd);
+
+		enemyManager->ClearEnemyQuadTree();
+		projectileManager->ClearProjectileQuadTree();
+	}
+	const float sequentialTime = MillisecondsSince(start);
+
+	randomEngine.seed(1234);
+	gameStateHandler->BackToFirstState();
+	gameStateHandler->AddState(std::make_shared<GameState>());
+
+	// Free running so the simulation ticks as fast as it can, the same as the sequential loop.
+	SimulationThread pipeline(_settings.fixedDeltaTime);
+	pipeline.SetFreeRunning(true);
+
+	double pipelinedLatency = 0.0;
+	double ticksBehind = 0.0;
+	unsigned int restarts = 0;
+	pipeline.Start();
+	start = SDL_GetPerformanceCounter();
+	for (unsigned int i = 0; i < _settings.ticks; i++) {
+		if (gameStateHandler->HasPendingStateChanges()) {
+			// The player died, the simulation thread stops itself and waits for a new game.
+			pipeline.Stop();
+			gameStateHandler->ReplaceCurrentState(std::make_shared<GameState>());
+			pipeline.Start();
+			restarts++;
+		}
+		pipeline.AcquireSnapshot();
+		const WorldSnapshot& snapshot = pipeline.GetSnapshot();
+
+		SDL_SetRenderDrawColor(renderer, 75, 75, 75, 255);
+		SDL_RenderClear(renderer);
+		snapshot.Render();
+		SDL_RenderPresent(renderer);
+		pipelinedLatency += (double)(SDL_GetPerformanceCounter() - snapshot.publishTime) * 1000.0 /
+			(double)SDL_GetPerformanceFrequency();
+		ticksBehind += pipeline.GetTick() - snapshot.tick;
+	}
+	const float pipelinedTime = MillisecondsSince(start);
+	const unsigned int ticksSimulated = pipeline.GetTicksSimulated();
+	pipeline.Stop();
+
+	printf("Frames: %u  broadphase %s\n", _settings.ticks, GetBroadphaseName(_settings.broadphaseType));
+	printf("%-11s %12s %12s %14s %12s\n", "Mode", "Frames/s", "Ticks/s", "Latency ms", "Ticks behind");
+	printf("%-11s %12.1f %12.1f %14.3f %12.2f\n", "Sequential",
+		_settings.ticks * 1000.f / sequentialTime, _settings.ticks * 1000.f / sequentialTime,
+		sequentialLatency / _settings.ticks, 0.0);
+	printf("%-11s %12.1f %12.1f %14.3f %12.2f\n", "Pipelined",
+		_settings.ticks * 1000.f / pipelinedTime, ticksSimulated * 1000.f / pipelinedTime,
+		pipelinedLatency / _settings.ticks, ticksBehind / _settings.ticks);
+	printf("Simulation restarts after player death: %u\n", restarts);
+}
+
+void HeadlessBenchmark::RunParallelBuildBenchmark() {
+	std::mt19937 engine(1234);
+	const unsigned int entityCounts[] = { 10000, 100000 };
+	const unsigned int maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	const unsigned int repeats = 20;
+
+	QuadTreeNode quadTreeNode;
+	quadTreeNode.rectangle = AABB::makeFromPositionSize(
+		Vector2<float>(windowWidth * 0.5f, windowHeight * 0.5f), windowHeight, windowWidth);
+
+	std::vector<unsigned int> threadCounts;
+	for (unsigned int threadCount = 1; threadCount < maxThreads; threadCount *= 2) {
+		threadCounts.emplace_back(threadCount);
+	}
+	threadCounts.emplace_back(maxThreads);
+
+	printf("%-8s %-8s %10s %10s %10s\n", "Entities", "Threads", "Build ms", "Speedup", "Identical");
+	for (unsigned int entityCount : entityCounts) {
+		std::vector<Circle> colliders = CreateRandomCircles(entityCount, 50.f, 8.f, 16.f, engine);
+		std::vector<Circle> queries = CreateRandomCircles(500, 0.f, 16.f, 64.f, engine);
+		std::vector<unsigned int> objects(entityCount);
+		std::iota(objects.begin(), objects.end(), 0);
+
+		// One by one insertion is the reference the bulk build has to match.
+		QuadTree<unsigned int> reference(quadTreeNode, 25, 2.f);
+		Uint64 start = SDL_GetPerformanceCounter();
+		for (unsigned int r = 0; r < repeats; r++) {
+			reference.Clear();
+			for (unsigned int i = 0; i < entityCount; i++) {
+				reference.Insert(objects[i], colliders[i]);
+			}
+		}
+		printf("%-8u %-8s %10.3f %10s %10s\n", entityCount, "Insert", MillisecondsSince(start) / repeats, "", "");
+
+		float singleThreadTime = 0.f;
+		for (unsigned int threadCount : threadCounts) {
+			workerPool->SetThreadCount(threadCount);
+			QuadTree<unsigned int> quadTree(quadTreeNode, 25, 2.f);
+			start = SDL_GetPerformanceCounter();
+			for (unsigned int r = 0; r < repeats; r++) {
+				quadTree.Clear();
+				quadTree.Build(objects, colliders);
+			}
+			const float buildTime = MillisecondsSince(start) / repeats;
+			if (threadCount == 1) {
+				singleThreadTime = buildTime;
+			}
+			printf("%-8u %-8u %10.3f %9.2fx %10s\n", entityCount, threadCount, buildTime, singleThreadTime / buildTime,
+				IsSameQuadTree(reference, quadTree, queries) ? "yes" : "NO");
+		}
+	}
+	workerPool->SetThreadCount(maxThreads);
+}
+
+void HeadlessBenchmark::RunSpatialSortBenchmark() {
+	// Same seed for both runs, so the only difference is the order entities are stored in.
+	// Compare the update and query phases, and their cache misses per entity with counters on.
+	const bool spatialSortValues[] = { false, true };
+	for (bool spatialSort : spatialSortValues) {
+		_settings.spatialSort = spatialSort;
+		ResetResults();
+		RunSimulation();
+		printf("\n");
+	}
+}
+
+void HeadlessBenchmark::RunAttackBenchmark() {
+	std::mt19937 engine(1234);
+	const unsigned int enemyCounts[] = { 250, 1000, 4000, 16000 };
+	// Spread 1 fills the window, spread 2 places enemies over twice its width and height.
+	const float spreads[] = { 1.f, 2.f };
+	const unsigned int repeats = 200;
+
+	randomEngine.seed(1234);
+	gameStateHandler->BackToFirstState();
+	gameStateHandler->AddState(std::make_shared<GameState>());
+
+	// Only the gathering is timed, resolving the attacks would damage the player. It is
+	// what replaced the distance check every enemy used to make against the player.
+	printf("%-8s %-7s %12s %12s %12s %12s %12s\n", "Enemies", "Spread", "All ms", "Query ms", "Adaptive ms", "Query tested", "Adaptive tested");
+	for (float spread : spreads) {
+		const Vector2<float> center(windowWidth * 0.5f, windowHeight * 0.5f);
+		std::uniform_real_distribution<float> distX{ center.x - center.x * spread, center.x + center.x * spread };
+		std::uniform_real_distribution<float> distY{ center.y - center.y * spread, center.y + center.y * spread };
+		for (unsigned int enemyCount : enemyCounts) {
+			enemyManager->RemoveAllEnemies();
+			for (unsigned int i = 0; i < enemyCount; i++) {
+				enemyManager->SpawnEnemy(i % 3 == 0 ? EnemyType::Boar : EnemyType::CoralineDad, 0.f,
+					Vector2<float>(0.f, 0.f), Vector2<float>(distX(engine), distY(engine)));
+			}
+			enemyManager->UpdateQuadTree();
+
+			// Modes are all enemies, always the player query and the query only when sparse.
+			float times[3] = {};
+			unsigned int tested[3] = {};
+			for (unsigned int mode = 0; mode < 3; mode++) {
+				weaponSystem->SetPlayerQueryEnabled(mode > 0, mode == 2);
+				const Uint64 start = SDL_GetPerformanceCounter();
+				for (unsigned int r = 0; r < repeats; r++) {
+					tested[mode] = weaponSystem->GatherAttackers();
+				}
+				times[mode] = MillisecondsSince(start) / repeats;
+			}
+			printf("%-8u %-7.0f %12.4f %12.4f %12.4f %12u %12u\n", enemyCount, spread, times[0], times[1], times[2], tested[1], tested[2]);
+			enemyManager->ClearEnemyQuadTree();
+		}
+	}
+	weaponSystem->SetPlayerQueryEnabled(true, true);
+	enemyManager->RemoveAllEnemies();
+}
+
+// Fires rings of enemy projectiles from the middle of the window, once with a
+// SpawnProjectile call per shot and once with SpawnPattern. Every wave is cleared
+// before the next one so both draw from the same warm pool.
+void HeadlessBenchmark::RunEmitterBenchmark() {
+	const unsigned int shotCounts[] = { 16, 128, 512, 2000 };
+	const unsigned int repeats = 200;
+	const Vector2<float> origin(windowWidth * 0.5f, windowHeight * 0.5f);
+
+	gameStateHandler->BackToFirstState();
+	gameStateHandler->AddState(std::make_shared<GameState>());
+	enemyManager->RemoveAllEnemies();
+	projectileManager->RemoveAllProjectiles();
+
+	printf("%-8s %14s %14s %10s\n", "Shots", "Per shot ms", "Pattern ms", "Speedup");
+	for (unsigned int shotCount : shotCounts) {
+		ProjectilePattern ring;
+		ring.type = ProjectilePatternType::Ring;
+		ring.count = shotCount;
+		ring.origin = origin;
+		ring.radius = 16.f;
+
+		const float angleStep = (float)(2.0 * PI / shotCount);
+		float times[2] = {};
+		for (unsigned int mode = 0; mode < 2; mode++) {
+			for (unsigned int r = 0; r < repeats; r++) {
+				const Uint64 start = SDL_GetPerformanceCounter();
+				if (mode == 0) {
+					for (unsigned int i = 0; i < shotCount; i++) {
+						const float orientation = angleStep * i;
+						const Vector2<float> direction = OrientationAsVector(orientation);
+						projectileManager->SpawnProjectile(ProjectileType::EnemyProjectile, orientation, 1, direction,
+							origin + direction * ring.radius);
+					}
+				} else {
+					projectileManager->SpawnPattern(ProjectileType::EnemyProjectile, 1, ring);
+				}
+				times[mode] += MillisecondsSince(start);
+				projectileManager->RemoveAllProjectiles();
+			}
+			times[mode] /= repeats;
+		}
+		printf("%-8u %14.4f %14.4f %9.2fx\n", shotCount, times[0], times[1], times[0] / times[1]);
+	}
+}
+
+static bool IsSameHits(const std::vector<BroadphaseHit<unsigned int>>& hitsA, const std::vector<BroadphaseHit<unsigned int>>& hitsB) {
+	if (hitsA.size() != hitsB.size()) {
+		return false;
+	}
+	// Compared by distance, objects at the same distance may come in either order.
+	for (unsigned int i = 0; i < hitsA.size(); i++) {
+		if (std::abs(hitsA[i].distance - hitsB[i].distance) > 0.001f) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Runs nearest neighbour, raycast and cone queries against 10k colliders in the loose
+// quadtree and the AABB tree, and the same queries testing every collider. Every result
+// is checked against the brute force one.
+void HeadlessBenchmark::RunSpatialQueryBenchmark() {
+	std::mt19937 engine(1234);
+	const unsigned int colliderCount = 10000;
+	const unsigned int queryCount = 1000;
+	const unsigned int nearestCount = 8;
+	const float rayLength = 400.f;
+	const float coneHalfAngle = 0.35f;
+	const float coneRange = 250.f;
+
+	const std::vector<Circle> colliders = CreateRandomCircles(colliderCount, 50.f, 8.f, 16.f, engine);
+	std::vector<unsigned int> objects(colliderCount);
+	std::iota(objects.begin(), objects.end(), 0);
+
+	std::uniform_real_distribution<float> distX{ 0.f, (float)windowWidth };
+	std::uniform_real_distribution<float> distY{ 0.f, (float)windowHeight };
+	std::uniform_real_distribution<float> distAngle{ -fastTrigPi, fastTrigPi };
+	std::vector<Vector2<float>> points(queryCount);
+	std::vector<Vector2<float>> ends(queryCount);
+	std::vector<Cone> cones(queryCount);
+	for (unsigned int q = 0; q < queryCount; q++) {
+		points[q] = Vector2<float>(distX(engine), distY(engine));
+		const float angle = distAngle(engine);
+		const Vector2<float> direction(std::cos(angle), std::sin(angle));
+		ends[q] = points[q] + direction * rayLength;
+		cones[q] = Cone::makeFromDirection(points[q], direction, coneHalfAngle, coneRange);
+	}
+
+	QuadTreeNode quadTreeNode;
+	quadTreeNode.rectangle = AABB::makeFromPositionSize(
+		Vector2(windowWidth * 0.5f, windowHeight * 0.5f), windowHeight, windowWidth);
+	QuadTree<unsigned int> quadTree(quadTreeNode, 25, 2.f);
+	AABBTree<unsigned int> aabbTree(8.f);
+	quadTree.Build(objects, colliders);
+	aabbTree.Build(objects, colliders);
+	Broadphase<unsigned int>* broadphases[] = { &quadTree, &aabbTree };
+
+	// Slot 0 is brute force, the rest follow broadphases. Brute force goes through the
+	// same heap and intersection functions the structures use.
+	std::vector<BroadphaseHit<unsigned int>> hits;
+	std::vector<BroadphaseHit<unsigned int>> expectedHits;
+	std::vector<unsigned int> objectsFound;
+	std::vector<unsigned int> expectedObjects;
+	auto runQuery = [&](unsigned int queryType, unsigned int slot, unsigned int q,
+		std::vector<BroadphaseHit<unsigned int>>& queryHits, std::vector<unsigned int>& queryObjects) {
+		if (slot > 0) {
+			Broadphase<unsigned int>* broadphase = broadphases[slot - 1];
+			if (queryType == 0) {
+				broadphase->QueryNearest(points[q], nearestCount, queryHits);
+			} else if (queryType == 1) {
+				broadphase->Raycast(points[q], ends[q], queryHits);
+			} else {
+				broadphase->QueryCone(cones[q], queryObjects);
+			}
+			return;
+		}
+		queryHits.clear();
+		queryObjects.clear();
+		float hitFraction = 0.f;
+		for (unsigned int i = 0; i < colliderCount; i++) {
+			if (queryType == 0) {
+				PushNearestHit(queryHits, nearestCount, i, Vector2<float>::squaredDistanceBetweenVectors(colliders[i].position, points[q]));
+			} else if (queryType == 1) {
+				if (SegmentCircleIntersect(points[q], ends[q], colliders[i], hitFraction)) {
+					queryHits.push_back({ i, hitFraction * rayLength });
+				}
+			} else if (ConeCircleIntersect(cones[q], colliders[i])) {
+				queryObjects.emplace_back(i);
+			}
+		}
+		if (queryType == 0) {
+			SortNearestHits(queryHits);
+		} else if (queryType == 1) {
+			std::sort(queryHits.begin(), queryHits.end(), [](const BroadphaseHit<unsigned int>& hitA, const BroadphaseHit<unsigned int>& hitB) {
+				return hitA.distance < hitB.distance;
+			});
+		}
+	};
+
+	const char* queryNames[] = { "Nearest 8", "Raycast 400 px", "Cone 40 deg 250 px" };
+	printf("%u colliders, %u queries of each type\n", colliderCount, queryCount);
+	printf("%-20s %10s %14s %10s %10s\n", "Query", "Brute ms", "LooseQuadTree", "AABBTree", "Mismatches");
+	for (unsigned int queryType = 0; queryType < 3; queryType++) {
+		float times[3] = {};
+		double resultCount = 0.0;
+		for (unsigned int slot = 0; slot < 3; slot++) {
+			const Uint64 start = SDL_GetPerformanceCounter();
+			for (unsigned int q = 0; q < queryCount; q++) {
+				runQuery(queryType, slot, q, hits, objectsFound);
+				resultCount += hits.size() + objectsFound.size();
+			}
+			times[slot] = MillisecondsSince(start);
+		}
+
+		unsigned int mismatches = 0;
+		for (unsigned int q = 0; q < queryCount; q++) {
+			runQuery(queryType, 0, q, expectedHits, expectedObjects);
+			std::sort(expectedObjects.begin(), expectedObjects.end());
+			for (unsigned int slot = 1; slot < 3; slot++) {
+				runQuery(queryType, slot, q, hits, objectsFound);
+				std::sort(objectsFound.begin(), objectsFound.end());
+				if (!IsSameHits(hits, expectedHits) || objectsFound != expectedObjects) {
+					mismatches++;
+				}
+			}
+		}
+		printf("%-20s %10.3f %14.3f %10.3f %10u  (%.1f results per query)\n", queryNames[queryType], times[0], times[1], times[2],
+			mismatches, resultCount / (3.0 * queryCount));
+	}
+}
+
+// Draws 1k to 50k randomly placed and rotated sprites, once with a RenderCopyEx call
+// per sprite and once through the software rasterizer. The rasterizer time is split
+// into rasterising the tiles and uploading and drawing the frame texture.
+void HeadlessBenchmark::RunRasterBenchmark() {
+	const char* spritePaths[] = { "res/sprites/Fireball.png", "res/sprites/Arcaneball.png", "res/sprites/CoralineDadKing.png" };
+	const unsigned int spriteCounts[] = { 1000, 10000, 50000 };
+	const unsigned int frames = 20;
+	std::mt19937 engine(1234);
+
+	std::vector<Sprite> sprites(sizeof(spritePaths) / sizeof(spritePaths[0]));
+	for (unsigned int i = 0; i < sprites.size(); i++) {
+		sprites[i].Load(spritePaths[i]);
+	}
+	std::uniform_real_distribution<float> distX{ 0.f, windowWidth };
+	std::uniform_real_distribution<float> distY{ 0.f, windowHeight };
+	std::uniform_real_distribution<float> distOrientation{ (float)-PI, (float)PI };
+	std::uniform_int_distribution<unsigned int> distSprite{ 0, (unsigned int)sprites.size() - 1 };
+
+	printf("%-8s %12s %12s %12s %12s %10s\n", "Sprites", "SDL ms", "Raster ms", "Tiles ms", "Upload ms", "Speedup");
+	for (unsigned int spriteCount : spriteCounts) {
+		std::vector<RenderItem> renderItems(spriteCount);
+		for (unsigned int i = 0; i < spriteCount; i++) {
+			renderItems[i].sprite = &sprites[distSprite(engine)];
+			renderItems[i].position = { distX(engine), distY(engine) };
+			renderItems[i].orientation = distOrientation(engine);
+		}
+
+		float sdlTime = 0.f;
+		for (unsigned int f = 0; f < frames; f++) {
+			const Uint64 start = SDL_GetPerformanceCounter();
+			SDL_RenderClear(renderer);
+			for (unsigned int i = 0; i < spriteCount; i++) {
+				renderItems[i].sprite->RenderWithOrientation(renderItems[i].position, renderItems[i].orientation);
+			}
+			sdlTime += MillisecondsSince(start);
+		}
+
+		float rasterTime = 0.f;
+		float tileTime = 0.f;
+		float uploadTime = 0.f;
+		for (unsigned int f = 0; f < frames; f++) {
+			const Uint64 start = SDL_GetPerformanceCounter();
+			spriteRasterizer->Render(renderItems);
+			rasterTime += MillisecondsSince(start);
+			tileTime += spriteRasterizer->GetRasterTime();
+			uploadTime += spriteRasterizer->GetUploadTime();
+		}
+		printf("%-8u %12.3f %12.3f %12.3f %12.3f %9.2fx\n", spriteCount, sdlTime / frames, rasterTime / frames,
+			tileTime / frames, uploadTime / frames, sdlTime / rasterTime);
+	}
+}
+
+// Draws 10k randomly rotated sprites with SDL_RenderCopyEx and then through the rotated
+// sprite cache at 16 to 256 angles, with the texture memory and bake time of each count.
+void HeadlessBenchmark::RunRotationBenchmark() {
+	const char* spritePaths[] = { "res/sprites/Fireball.png", "res/sprites/Arcaneball.png", "res/sprites/CoralineDadKing.png" };
+	const unsigned int angleCounts[] = { 16, 32, 64, 128, 256 };
+	const unsigned int spriteCount = 10000;
+	const unsigned int frames = 20;
+	std::mt19937 engine(1234);
+
+	std::vector<Sprite> sprites(sizeof(spritePaths) / sizeof(spritePaths[0]));
+	for (unsigned int i = 0; i < sprites.size(); i++) {
+		sprites[i].Load(spritePaths[i]);
+	}
+	std::uniform_real_distribution<float> distX{ 0.f, windowWidth };
+	std::uniform_real_distribution<float> distY{ 0.f, windowHeight };
+	std::uniform_real_distribution<float> distOrientation{ (float)-PI, (float)PI };
+	std::uniform_int_distribution<unsigned int> distSprite{ 0, (unsigned int)sprites.size() - 1 };
+	std::vector<RenderItem> renderItems(spriteCount);
+	for (unsigned int i = 0; i < spriteCount; i++) {
+		renderItems[i].sprite = &sprites[distSprite(engine)];
+		renderItems[i].position = { distX(engine), distY(engine) };
+		renderItems[i].orientation = distOrientation(engine);
+	}
+
+	const bool wasEnabled = rotatedSpriteCache->IsEnabled();
+	const unsigned int previousAngleCount = rotatedSpriteCache->GetAngleCount();
+	auto timeFrames = [&]() {
+		const Uint64 start = SDL_GetPerformanceCounter();
+		for (unsigned int f = 0; f < frames; f++) {
+			SDL_RenderClear(renderer);
+			for (unsigned int i = 0; i < spriteCount; i++) {
+				renderItems[i].sprite->RenderWithOrientation(renderItems[i].position, renderItems[i].orientation);
+			}
+		}
+		return MillisecondsSince(start) / frames;
+	};
+
+	printf("%u sprites\n", spriteCount);
+	printf("%-10s %12s %12s %14s %12s\n", "Angles", "Draw ms", "Bake ms", "Texture KB", "Error deg");
+	rotatedSpriteCache->SetEnabled(false);
+	printf("%-10s %12.3f %12s %14s %12s\n", "RenderEx", timeFrames(), "-", "-", "-");
+	rotatedSpriteCache->SetEnabled(true);
+	for (unsigned int angleCount : angleCounts) {
+		rotatedSpriteCache->SetAngleCount(angleCount);
+		printf("%-10u %12.3f %12.3f %14zu %12.2f\n", angleCount, timeFrames(), rotatedSpriteCache->GetBakeTime(),
+			rotatedSpriteCache->GetTextureBytes() / 1024, 180.f / angleCount);
+	}
+	rotatedSpriteCache->SetAngleCount(previousAngleCount);
+	rotatedSpriteCache->SetEnabled(wasEnabled);
+}
+
+// Plays 600 ticks to fill the world, then renders paused and menu frames with the
+// render cache off and on. With the cache on every frame after the first is one copy.
+void HeadlessBenchmark::RunPauseBenchmark() {
+	const unsigned int warmupTicks = 600;
+	const unsigned int frames = 600;
+	enemyManager->SetLevelOfDetailEnabled(_settings.levelOfDetail);
+	mouseButtons[SDL_BUTTON_LEFT].state = _settings.playerFiring;
+
+	randomEngine.seed(1234);
+	gameStateHandler->BackToFirstState();
+	gameStateHandler->AddState(std::make_shared<GameState>());
+	for (unsigned int i = 0; i < warmupTicks; i++) {
+		frameNumber++;
+		deltaTime = _settings.fixedDeltaTime;
+		gameStateHandler->UpdateState();
+		if (playerCharacter->GetCurrentHealth() <= 0) {
+			gameStateHandler->ReplaceCurrentState(std::make_shared<GameState>());
+		}
+		enemyManager->ClearEnemyQuadTree();
+		projectileManager->ClearProjectileQuadTree();
+	}
+	unsigned int entityCount = 0;
+	for (unsigned int i = 0; i < (unsigned int)EnemyType::Count; i++) {
+		entityCount += enemyManager->GetActiveEnemyCount((EnemyType)i);
+	}
+	for (unsigned int i = 0; i < (unsigned int)ProjectileType::Count; i++) {
+		entityCount += projectileManager->GetActiveProjectileCount((ProjectileType)i);
+	}
+
+	const bool wasEnabled = gameStateHandler->IsRenderCachingEnabled();
+	auto timeFrames = [&](bool renderCachingEnabled) {
+		gameStateHandler->SetRenderCachingEnabled(renderCachingEnabled);
+		const Uint64 start = SDL_GetPerformanceCounter();
+		for (unsigned int f = 0; f < frames; f++) {
+			SDL_SetRenderDrawColor(renderer, 75, 75, 75, 255);
+			SDL_RenderClear(renderer);
+			gameStateHandler->RenderState();
+			SDL_RenderPresent(renderer);
+		}
+		return MillisecondsSince(start) / frames;
+	};
+
+	printf("%u entities in the paused world, %u frames\n", entityCount, frames);
+	printf("%-8s %12s %12s %10s\n", "State", "Uncached ms", "Cached ms", "Speedup");
+	gameStateHandler->AddState(std::make_shared<PauseState>());
+	const float pausedUncached = timeFrames(false);
+	const float pausedCached = timeFrames(true);
+	printf("%-8s %12.4f %12.4f %9.2fx\n", "Pause", pausedUncached, pausedCached, pausedUncached / pausedCached);
+	gameStateHandler->BackToFirstState();
+	const float menuUncached = timeFrames(false);
+	const float menuCached = timeFrames(true);
+	printf("%-8s %12.4f %12.4f %9.2fx\n", "Menu", menuUncached, menuCached, menuUncached / menuCached);
+
+	gameStateHandler->SetRenderCachingEnabled(wasEnabled);
+}
+
+// Fills the debug drawer with a loose quadtree over 10k colliders and a circle per
+// collider, the circles added from the worker pool, and times adding and submitting.
+void HeadlessBenchmark::RunDebugDrawBenchmark() {
+	std::mt19937 engine(1234);
+	const unsigned int colliderCount = 10000;
+	const unsigned int taskCount = 16;
+	const unsigned int frames = 60;
+	const std::vector<Circle> colliders = CreateRandomCircles(colliderCount, 0.f, 4.f, 16.f, engine);
+	std::vector<unsigned int> objects(colliderCount);
+	std::iota(objects.begin(), objects.end(), 0);
+
+	QuadTreeNode quadTreeNode;
+	quadTreeNode.rectangle = AABB::makeFromPositionSize(
+		Vector2(windowWidth * 0.5f, windowHeight * 0.5f), windowHeight, windowWidth);
+	QuadTree<unsigned int> quadTree(quadTreeNode, 25, 2.f);
+	quadTree.Build(objects, colliders);
+
+	float addTime = 0.f;
+	float drawTime = 0.f;
+	for (unsigned int f = 0; f < frames; f++) {
+		const Uint64 addStart = SDL_GetPerformanceCounter();
+		quadTree.Render();
+		workerPool->Run(taskCount, [&](unsigned int task) {
+			for (unsigned int i = task; i < colliderCount; i += taskCount) {
+				debugDrawer->AddDebugCircle(colliders[i].position, colliders[i].radius, { 255, 128, 0, 255 });
+			}
+		});
+		addTime += MillisecondsSince(addStart);
+
+		const Uint64 drawStart = SDL_GetPerformanceCounter();
+		debugDrawer->Draw();
+		drawTime += MillisecondsSince(drawStart);
+	}
+	printf("%u nodes, %u circles, %u vertices in one submit\n", quadTree.GetStatistics().nodeCount, colliderCount,
+		debugDrawer->GetLastVertexCount());
+	printf("Add %.3f ms  Draw %.3f ms per frame\n", addTime / frames, drawTime / frames);
+}
+
+// Builds the game's debug overlay every frame and renders it with the geometry backend
+// and with imgui_sdl. Building the windows is the same for both, so it is timed apart.
+void HeadlessBenchmark::RunImGuiBenchmark() {
+	const unsigned int frames = 300;
+	const char* backendNames[] = { "SDLRenderer", "imgui_sdl" };
+	const ImGuiRenderBackend previousRenderBackend = imGuiHandler->GetRenderBackend();
+
+	printf("%-12s %10s %10s %10s %10s\n", "Backend", "Build ms", "Render ms", "Lists", "Vertices");
+	for (unsigned int backend = 0; backend < (unsigned int)ImGuiRenderBackend::Count; backend++) {
+		imGuiHandler->SetRenderBackend((ImGuiRenderBackend)backend);
+		float buildTime = 0.f;
+		float renderTime = 0.f;
+		for (unsigned int f = 0; f < frames; f++) {
+			imGuiHandler->NewFrame();
+			const Uint64 buildStart = SDL_GetPerformanceCounter();
+			performanceProfiler->UpdateImgui();
+			imGuiHandler->UpdateImgui();
+			gameStateHandler->UpdateImgui();
+			frameSpikeRecorder->UpdateImgui();
+			enemyManager->UpdateImgui();
+			projectileManager->UpdateImgui();
+			weaponSystem->UpdateImgui();
+			simulationThread->UpdateImgui();
+			inputQueue->UpdateImgui();
+			spriteRasterizer->UpdateImgui();
+			rotatedSpriteCache->UpdateImgui();
+			buildTime += MillisecondsSince(buildStart);
+			imGuiHandler->Render();
+			renderTime += imGuiHandler->GetRenderTime();
+		}
+		const ImDrawData* drawData = ImGui::GetDrawData();
+		printf("%-12s %10.3f %10.3f %10d %10d\n", backendNames[backend], buildTime / frames, renderTime / frames,
+			drawData->CmdListsCount, drawData->TotalVtxCount);
+	}
+	imGuiHandler->SetRenderBackend(previousRenderBackend);
+	imGuiHandler->NewFrame();
+	ImGui::EndFrame();
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "broadphase.h"
+#include "hardwareCounters.h"
+#include "performanceProfiler.h"
+
+#include <array>
+#include <vector>
+
+enum class BenchmarkScenario {
+	Simulation,
+	QuadTree,
+	Broadphase,
+	VectorMath,
+	Trig,
+	Pipeline,
+	ParallelBuild,
+	SpatialSort,
+	Attack,
+	Emitter,
+	SpatialQuery,
+	Raster,
+	Rotation,
+	Pause,
+	DebugDraw,
+	ImGui,
+	Count
+};
+
+struct BenchmarkSettings {
+	BenchmarkScenario scenario = BenchmarkScenario::Simulation;
+	BroadphaseType broadphaseType = BroadphaseType::LooseQuadTree;
+
+	unsigned int ticks = 3600;
+	float fixedDeltaTime = 1.f / 60.f;
+	float spikeBudget = 1000.f / 60.f;
+
+	bool hardwareCounters = true;
+	bool levelOfDetail = true;
+	bool playerFiring = true;
+	bool spatialSort = true;
+	bool renderFrames = false;
+};
+
+bool IsBenchmarkRequested(int argc, char* argv[]);
+BenchmarkSettings ParseBenchmarkSettings(int argc, char* argv[]);
+
+// Runs the game simulation without a visible window for a fixed number of ticks
+// and prints per-phase timings (and hardware counters when available) to stdout.
+class HeadlessBenchmark {
+public:
+	HeadlessBenchmark(BenchmarkSettings settings);
+	~HeadlessBenchmark() {}
+
+	void Run();
+
+private:
+	void RunSimulation();
+	void RunTick();
+	void PrintResults();
+	void ResetResults();
+
+	void RunQuadTreeBenchmark();
+	void RunBroadphaseBenchmark();
+	void RunVectorMathBenchmark();
+	void RunTrigBenchmark();
+	void RunPipelineBenchmark();
+	void RunParallelBuildBenchmark();
+	void RunSpatialSortBenchmark();
+	void RunAttackBenchmark();
+	void RunEmitterBenchmark();
+	void RunSpatialQueryBenchmark();
+	void RunRasterBenchmark();
+	void RunRotationBenchmark();
+	void RunPauseBenchmark();
+	void RunDebugDrawBenchmark();
+	void RunImGuiBenchmark();
+
+	BenchmarkSettings _settings;
+
+	std::array<double, (unsigned int)ProfilerPhase::Count> _phaseTotals = {};
+	std::array<HardwareCounterSample, (unsigned int)ProfilerPhase::Count> _phaseCounters;
+
+	std::vector<float> _tickTimes;
+
+	double _entityTicks = 0.0;
+	double _levelOfDetailTimeSaved = 0.0;
+	double _skippedUpdates = 0.0;
+	double _maskedResults = 0.0;
+	double _unmaskedResults = 0.0;
+
+	unsigned int _playerDeaths = 0;
+};
@@ -0,0 +1,35 @@
+#include "broadphase.h"
+
+const char* GetBroadphaseName(BroadphaseType broadphaseType) {
+	switch (broadphaseType) {
+	case BroadphaseType::QuadTree:
+		return "QuadTree";
+	case BroadphaseType::LooseQuadTree:
+		return "LooseQuadTree";
+	case BroadphaseType::AABBTree:
+		return "AABBTree";
+	default:
+		return "Unknown";
+	}
+}
+
+const float BroadphaseStatistics::GetAverageQueryResult() const {
+	if (queryCount == 0) {
+		return 0.f;
+	}
+	return (float)queryResultCount / (float)queryCount;
+}
+
+const float BroadphaseStatistics::GetAverageMaskedResult() const {
+	if (layeredQueryCount == 0) {
+		return 0.f;
+	}
+	return (float)maskedResultCount / (float)layeredQueryCount;
+}
+
+const float BroadphaseStatistics::GetAverageUnmaskedResult() const {
+	if (layeredQueryCount == 0) {
+		return 0.f;
+	}
+	return (float)unmaskedResultCount / (float)layeredQueryCount;
+}
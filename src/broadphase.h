@@ -0,0 +1,104 @@
+#pragma once
+#include "collision.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+enum class BroadphaseType {
+	QuadTree,
+	LooseQuadTree,
+	AABBTree,
+	Count
+};
+
+const char* GetBroadphaseName(BroadphaseType broadphaseType);
+
+struct BroadphaseStatistics {
+	std::array<unsigned int, 16> depthHistogram = {};
+	unsigned int nodeCount = 0;
+	unsigned int objectCount = 0;
+	unsigned int overflowCount = 0;
+	unsigned int queryCount = 0;
+	unsigned int queryResultCount = 0;
+	unsigned int reinsertCount = 0;
+	// Only filled by LayeredBroadphase, summed over its queries: the objects the masked
+	// queries returned and the objects one query over every layer would have returned.
+	unsigned int layeredQueryCount = 0;
+	unsigned int maskedResultCount = 0;
+	unsigned int unmaskedResultCount = 0;
+
+	const float GetAverageQueryResult() const;
+	const float GetAverageMaskedResult() const;
+	const float GetAverageUnmaskedResult() const;
+};
+
+template<typename T>
+struct BroadphaseHit {
+	T object = T();
+	// From the query point for QueryNearest, along the segment for Raycast.
+	float distance = 0.f;
+};
+
+// Keeps the count closest candidates as a max heap on the squared distance while a
+// nearest neighbour search runs, SortNearestHits turns it into the final list.
+template<typename T>
+inline void PushNearestHit(std::vector<BroadphaseHit<T>>& hits, unsigned int count, const T& object, float squaredDistance) {
+	auto isCloser = [](const BroadphaseHit<T>& hitA, const BroadphaseHit<T>& hitB) { return hitA.distance < hitB.distance; };
+	if (hits.size() < count) {
+		hits.push_back({ object, squaredDistance });
+		std::push_heap(hits.begin(), hits.end(), isCloser);
+	} else if (squaredDistance < hits.front().distance) {
+		std::pop_heap(hits.begin(), hits.end(), isCloser);
+		hits.back() = { object, squaredDistance };
+		std::push_heap(hits.begin(), hits.end(), isCloser);
+	}
+}
+
+template<typename T>
+inline void SortNearestHits(std::vector<BroadphaseHit<T>>& hits) {
+	std::sort_heap(hits.begin(), hits.end(), [](const BroadphaseHit<T>& hitA, const BroadphaseHit<T>& hitB) {
+		return hitA.distance < hitB.distance;
+	});
+	for (unsigned int i = 0; i < hits.size(); i++) {
+		hits[i].distance = std::sqrt(hits[i].distance);
+	}
+}
+
+// Common interface for the spatial structures the managers fill every frame.
+// Objects are inserted once per frame and Clear is called when the frame is done.
+// Query can be called from several threads at once while nothing is inserted.
+template<typename T>
+class Broadphase {
+public:
+	virtual ~Broadphase() {}
+
+	virtual bool Insert(T object, Circle circleCollider) = 0;
+
+	// Inserts every object in order, structures that can do better in bulk override this.
+	virtual void Build(const std::vector<T>& objects, const std::vector<Circle>& circleColliders) {
+		for (unsigned int i = 0; i < objects.size(); i++) {
+			Insert(objects[i], circleColliders[i]);
+		}
+	}
+
+	virtual std::vector<T> Query(Circle range) = 0;
+
+	// The queries below clear and fill the caller's vector and keep their traversal state in
+	// per thread buffers, so they stop allocating once the vectors have grown.
+
+	virtual void Query(Circle range, std::vector<T>& objectsFound) = 0;
+
+	// The count objects with their collider centres closest to point, nearest first.
+	virtual void QueryNearest(Vector2<float> point, unsigned int count, std::vector<BroadphaseHit<T>>& hits) = 0;
+	// Every collider the segment passes through, in the order the segment enters them.
+	virtual void Raycast(Vector2<float> start, Vector2<float> end, std::vector<BroadphaseHit<T>>& hits) = 0;
+	virtual void QueryCone(const Cone& cone, std::vector<T>& objectsFound) = 0;
+
+	virtual BroadphaseStatistics GetStatistics() = 0;
+
+	virtual void Clear() = 0;
+
+	virtual void Render() = 0;
+};
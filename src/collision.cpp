@@ -2,8 +2,10 @@
 #include "debugDrawer.h"
 #include "gameEngine.h"
 
+#include <cmath>
 #include <minmax.h>
 #include <SDL2/SDL.h>
+#include <utility>
 
 AABB AABB::makeFromPositionSize(Vector2<float> position, float h, float w) {
 	AABB boxCollider;
@@ -17,15 +19,25 @@ AABB AABB::makeFromPositionSize(Vector2<float> position, float h, float w) {
 	return boxCollider;
 }
 
+Cone Cone::makeFromDirection(Vector2<float> position, Vector2<float> direction, float halfAngle, float range) {
+	Cone cone;
+	cone.position = position;
+	cone.direction = direction.normalized();
+	cone.halfAngle = halfAngle;
+	cone.cosHalfAngle = std::cos(halfAngle);
+	cone.sinHalfAngle = std::sin(halfAngle);
+	cone.range = range;
+	return cone;
+}
+
 bool CircleIntersect(Circle& circleA, Circle& circleB) {
 	float dx = circleB.position.x - circleA.position.x;
 	float dy = circleB.position.y - circleA.position.y;
 
 	float distanceSquared = dx * dx + dy * dy;
-	float distance = sqrt(distanceSquared);
 
 	float radiusSum = circleA.radius + circleB.radius;
-	return distance < radiusSum;
+	return distanceSquared < radiusSum * radiusSum;
 }
 
 bool AABBIntersect(AABB& boxA, AABB& boxB) {
@@ -55,8 +67,106 @@ bool AABBCircleIntersect(AABB& box, Circle& circle) {
 	float deltaY = circle.position.y - clampedY;
 
 	float distanceSquared = deltaX * deltaX + deltaY * deltaY;
-	float distance = sqrt(distanceSquared);
-	return (distance < circle.radius);
+	return (distanceSquared < circle.radius * circle.radius);
+}
+
+bool AABBContainsCircle(AABB& box, Circle& circle) {
+	return (
+		circle.position.x - circle.radius >= box.min.x &&
+		circle.position.x + circle.radius <= box.max.x &&
+		circle.position.y - circle.radius >= box.min.y &&
+		circle.position.y + circle.radius <= box.max.y);
+}
+
+float AABBDistanceSquared(const AABB& box, Vector2<float> point) {
+	const float deltaX = point.x - Clamp(point.x, box.min.x, box.max.x);
+	const float deltaY = point.y - Clamp(point.y, box.min.y, box.max.y);
+	return deltaX * deltaX + deltaY * deltaY;
+}
+
+// Slab test, the segment is clipped against the x and then the y extent of the box.
+bool SegmentAABBIntersect(const AABB& box, Vector2<float> start, Vector2<float> end) {
+	const float startValues[2] = { start.x, start.y };
+	const float deltaValues[2] = { end.x - start.x, end.y - start.y };
+	const float minValues[2] = { box.min.x, box.min.y };
+	const float maxValues[2] = { box.max.x, box.max.y };
+	float entryFraction = 0.f;
+	float exitFraction = 1.f;
+	for (unsigned int axis = 0; axis < 2; axis++) {
+		if (deltaValues[axis] == 0.f) {
+			if (startValues[axis] < minValues[axis] || startValues[axis] > maxValues[axis]) {
+				return false;
+			}
+			continue;
+		}
+		const float inverseDelta = 1.f / deltaValues[axis];
+		float axisEntry = (minValues[axis] - startValues[axis]) * inverseDelta;
+		float axisExit = (maxValues[axis] - startValues[axis]) * inverseDelta;
+		if (axisEntry > axisExit) {
+			std::swap(axisEntry, axisExit);
+		}
+		entryFraction = axisEntry > entryFraction ? axisEntry : entryFraction;
+		exitFraction = axisExit < exitFraction ? axisExit : exitFraction;
+		if (entryFraction > exitFraction) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool SegmentCircleIntersect(Vector2<float> start, Vector2<float> end, const Circle& circle, float& hitFraction) {
+	const Vector2<float> delta = end - start;
+	const Vector2<float> offset = start - circle.position;
+	const float c = Vector2<float>::dotProduct(offset, offset) - circle.radius * circle.radius;
+	if (c <= 0.f) {
+		hitFraction = 0.f;
+		return true;
+	}
+	const float a = Vector2<float>::dotProduct(delta, delta);
+	const float b = Vector2<float>::dotProduct(offset, delta);
+	const float discriminant = b * b - a * c;
+	if (a == 0.f || b >= 0.f || discriminant < 0.f) {
+		return false;
+	}
+	const float fraction = (-b - std::sqrt(discriminant)) / a;
+	if (fraction > 1.f) {
+		return false;
+	}
+	hitFraction = fraction;
+	return true;
+}
+
+// The circle is inside when the angle to its centre is within the half angle plus the angle
+// the circle covers seen from the tip. Compared as cosines of the summed angles.
+bool ConeCircleIntersect(const Cone& cone, const Circle& circle) {
+	const Vector2<float> offset = circle.position - cone.position;
+	const float squaredDistance = offset.squaredAbsolute();
+	if (squaredDistance <= circle.radius * circle.radius) {
+		return true;
+	}
+	const float reach = cone.range + circle.radius;
+	if (squaredDistance > reach * reach) {
+		return false;
+	}
+	const float distance = std::sqrt(squaredDistance);
+	const float sinCircle = circle.radius / distance;
+	const float cosCircle = std::sqrt(1.f - sinCircle * sinCircle);
+	// Past pi the summed angle wraps and the whole circle around the tip is covered.
+	if (cone.sinHalfAngle * cosCircle + cone.cosHalfAngle * sinCircle < 0.f) {
+		return true;
+	}
+	const float cosLimit = cone.cosHalfAngle * cosCircle - cone.sinHalfAngle * sinCircle;
+	return Vector2<float>::dotProduct(offset, cone.direction) >= cosLimit * distance;
+}
+
+bool ConeAABBIntersect(const Cone& cone, const AABB& box) {
+	if (AABBDistanceSquared(box, cone.position) > cone.range * cone.range) {
+		return false;
+	}
+	Circle boundingCircle;
+	boundingCircle.position = Vector2<float>((box.min.x + box.max.x) * 0.5f, (box.min.y + box.max.y) * 0.5f);
+	boundingCircle.radius = (box.max - box.min).absolute() * 0.5f;
+	return ConeCircleIntersect(cone, boundingCircle);
 }
 
 void AABB::SetPosition(Vector2<float> newPosition) {
@@ -26,8 +26,38 @@ struct AABB {
 	Vector2<float> max = Vector2<float>(0.f, 0.f);
 };
 
+// A sector of a circle, used for shotgun style weapons. The sine and cosine of the half
+// angle are kept so the intersection test needs no trig.
+struct Cone {
+	static Cone makeFromDirection(Vector2<float> position, Vector2<float> direction, float halfAngle, float range);
+
+	float halfAngle = 0.f;
+	float cosHalfAngle = 1.f;
+	float sinHalfAngle = 0.f;
+	float range = 0.f;
+
+	Vector2<float> position = Vector2<float>(0.f, 0.f);
+	Vector2<float> direction = Vector2<float>(0.f, -1.f);
+};
+
 bool CircleIntersect(Circle& circleA, Circle& circleB);
 
 bool AABBIntersect(AABB& boxA, AABB& boxB);
 
-bool AABBCircleIntersect(AABB& box, Circle& circle);
\ No newline at end of file
+bool AABBCircleIntersect(AABB& box, Circle& circle);
+
+bool AABBContainsCircle(AABB& box, Circle& circle);
+
+float AABBDistanceSquared(const AABB& box, Vector2<float> point);
+
+bool SegmentAABBIntersect(const AABB& box, Vector2<float> start, Vector2<float> end);
+
+// hitFraction is where along the segment it enters the circle, 0 when it starts inside.
+bool SegmentCircleIntersect(Vector2<float> start, Vector2<float> end, const Circle& circle, float& hitFraction);
+
+// Exact against the sides of the cone, a circle beyond the far arc but within range plus
+// its radius of the tip counts as a hit.
+bool ConeCircleIntersect(const Cone& cone, const Circle& circle);
+
+// Conservative, the box is tested through the circle around it. Meant for culling nodes.
+bool ConeAABBIntersect(const Cone& cone, const AABB& box);
\ No newline at end of file
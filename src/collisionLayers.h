@@ -0,0 +1,20 @@
+#pragma once
+
+// Every collider lives on one layer, and queries pass a mask of the layers they want
+// to see. Layers get their own broadphase, so a query never walks past colliders
+// from layers outside its mask. The enemy layer is the enemy manager's broadphase,
+// the projectile layers share a LayeredBroadphase in the projectile manager.
+enum class CollisionLayer {
+	Enemy,
+	PlayerProjectile,
+	EnemyProjectile,
+	Count
+};
+
+typedef unsigned int CollisionMask;
+
+constexpr CollisionMask CollisionLayerBit(CollisionLayer collisionLayer) {
+	return 1u << (unsigned int)collisionLayer;
+}
+
+const CollisionMask allCollisionLayers = (1u << (unsigned int)CollisionLayer::Count) - 1u;
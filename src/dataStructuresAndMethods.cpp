@@ -1,10 +1,11 @@
 #include "dataStructuresAndMethods.h"
+#include "fastTrig.h"
 #include "gameEngine.h"
 #include "objectBase.h"
 
 
 bool IsInDistance(Vector2<float> positionA, Vector2<float> positionB, float distance) {
-	return Vector2<float>::distanceBetweenVectors(positionA, positionB) <= distance;
+	return Vector2<float>::isWithinDistance(positionA, positionB, distance);
 }
 
 bool OutOfBorderX(float positionX) {
@@ -25,12 +26,14 @@ Vector2<float> GetCursorPosition() {
 }
 
 Vector2<float> OrientationAsVector(float orientation) {
-	return  Vector2<float>(-sinf(orientation), cosf(orientation)).normalized();
+	float sine;
+	float cosine;
+	FastSinCos(orientation, sine, cosine);
+	return Vector2<float>(-sine, cosine);
 }
 
 float VectorAsOrientation(Vector2<float> direction) {
-	direction.normalize();
-	return atan2f(direction.x, -direction.y);
+	return FastAtan2(direction.x, -direction.y);
 }
 
 float WrapMax(float rotation, float maxValue) {
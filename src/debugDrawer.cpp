@@ -1,97 +1,147 @@
 #include "debugDrawer.h"
+#include "fastTrig.h"
 #include "gameEngine.h"
 
-#include <SDL2/SDL.h>
+#include <algorithm>
+#include <atomic>
 
-void DebugDrawer::AddDebugBox(Vector2<float> position, Vector2<float> min, Vector2<float> max, std::array<int, 4> color) {
-	DebugBox debugBox;
-	debugBox.min = min;
-	debugBox.max = max;
-	debugBox.position = position;
-	debugBox.color = color;
-	_debugBox.emplace_back(debugBox);
-}
+static std::atomic<unsigned int> nextDrawerId = 1;
 
-void DebugDrawer::AddDebugCircle(Vector2<float> position, float radius, std::array<int, 4> color) {
-	DebugCircle debugCircle;
-	debugCircle.position = position;
-	debugCircle.radius = radius;
-	debugCircle.color = color;
-	_debugCircles.emplace_back(debugCircle);
+static SDL_Color ToColor(const std::array<int, 4>& color) {
+	return { (Uint8)color[0], (Uint8)color[1], (Uint8)color[2], (Uint8)color[3] };
 }
 
-void DebugDrawer::AddDebugCross(Vector2<float> position, float length, std::array<int, 4> color) {
-	DebugLine debugLineHorizontal;
-	DebugLine debugLineVertical;
-
-	debugLineHorizontal.startPosition = Vector2<float>(position.x - (length * 0.5f), position.y);
-	debugLineHorizontal.endPosition = Vector2<float>(position.x + (length * 0.5f), position.y);
-	debugLineHorizontal.color = color;
+static void PushVertex(DebugVertexBuffer& buffer, Vector2<float> position, SDL_Color color) {
+	buffer.vertices.push_back({ { position.x, position.y }, color, { 0.f, 0.f } });
+}
 
-	debugLineVertical.startPosition = Vector2<float>(position.x, position.y - (length * 0.5f));
-	debugLineVertical.endPosition = Vector2<float>(position.x, position.y + (length * 0.5f));
-	debugLineVertical.color = color;
+// A closed outline between matching outer and inner points, two triangles per edge.
+static void PushOutline(DebugVertexBuffer& buffer, const Vector2<float>* outerPoints, const Vector2<float>* innerPoints,
+	unsigned int pointCount, SDL_Color color) {
+	const int first = (int)buffer.vertices.size();
+	for (unsigned int i = 0; i < pointCount; i++) {
+		PushVertex(buffer, outerPoints[i], color);
+		PushVertex(buffer, innerPoints[i], color);
+	}
+	for (unsigned int i = 0; i < pointCount; i++) {
+		const int outer = first + i * 2;
+		const int nextOuter = first + ((i + 1) % pointCount) * 2;
+		buffer.indices.insert(buffer.indices.end(), { outer, outer + 1, nextOuter, outer + 1, nextOuter + 1, nextOuter });
+	}
+}
 
-	_debugLines.emplace_back(debugLineHorizontal);
-	_debugLines.emplace_back(debugLineVertical);
+DebugDrawer::DebugDrawer() {
+	_drawerId = nextDrawerId.fetch_add(1);
 }
 
-void DebugDrawer::AddDebugLine(Vector2<float> startPosition, Vector2<float> endPosition, std::array<int, 4> color) {
-	DebugLine debugLine;
-	debugLine.startPosition = startPosition;
-	debugLine.endPosition = endPosition;
-	debugLine.color = color;
-	_debugLines.emplace_back(debugLine);
+// Covers the same pixels as SDL_RenderDrawRect on the box centred on position.
+void DebugDrawer::AddDebugBox(Vector2<float> position, Vector2<float> min, Vector2<float> max, std::array<int, 4> color) {
+	const float x = (float)(int)(position.x - (max.x - min.x) * 0.5f);
+	const float y = (float)(int)(position.y - (max.y - min.y) * 0.5f);
+	const float w = (float)(int)(max.x - min.x);
+	const float h = (float)(int)(max.y - min.y);
+	const Vector2<float> outerPoints[4] = { { x, y }, { x + w, y }, { x + w, y + h }, { x, y + h } };
+	const Vector2<float> innerPoints[4] = { { x + 1.f, y + 1.f }, { x + w - 1.f, y + 1.f }, { x + w - 1.f, y + h - 1.f }, { x + 1.f, y + h - 1.f } };
+	PushOutline(GetThreadBuffer(), outerPoints, innerPoints, 4, ToColor(color));
 }
 
-void DebugDrawer::DrawBoxes() {
-	for (int i = 0; i < _debugBox.size(); i++) {
-		SDL_SetRenderDrawColor(renderer, _debugBox[i].color[0], _debugBox[i].color[1], _debugBox[i].color[2], _debugBox[i].color[3]);
-		SDL_Rect rect = {
-			_debugBox[i].position.x - ((_debugBox[i].max.x - _debugBox[i].min.x) * 0.5f),
-			_debugBox[i].position.y - ((_debugBox[i].max.y - _debugBox[i].min.y) * 0.5f),
-			_debugBox[i].max.x - _debugBox[i].min.x,
-			_debugBox[i].max.y - _debugBox[i].min.y			
-		};
-		SDL_RenderDrawRect(renderer, &rect);
+void DebugDrawer::AddDebugCircle(Vector2<float> position, float radius, std::array<int, 4> color) {
+	const UnitCircleTable& unitCircle = GetUnitCircleTable();
+	Vector2<float> outerPoints[UnitCircleTable::resolution];
+	Vector2<float> innerPoints[UnitCircleTable::resolution];
+	for (unsigned int k = 0; k < UnitCircleTable::resolution; k++) {
+		outerPoints[k] = unitCircle.points[k] * (radius + 0.5f) + position;
+		innerPoints[k] = unitCircle.points[k] * (radius - 0.5f) + position;
 	}
-	_debugBox.clear();
+	PushOutline(GetThreadBuffer(), outerPoints, innerPoints, UnitCircleTable::resolution, ToColor(color));
 }
 
-void DebugDrawer::DrawCircles() {
-	for (int i = 0; i < _debugCircles.size(); i++) {
-		SDL_SetRenderDrawColor(renderer, _debugBox[i].color[0], _debugBox[i].color[1], _debugBox[i].color[2], _debugBox[i].color[3]);
-
-		int resolution = 24;
-		float step = (2 * PI) / resolution;
-
-		for (int k = 0; k < resolution; k++) {
-
-			float angle = step * k;
-			float x1 = cos(angle);
-			float y1 = sin(angle);
+void DebugDrawer::AddDebugCross(Vector2<float> position, float length, std::array<int, 4> color) {
+	AddDebugLine(Vector2<float>(position.x - (length * 0.5f), position.y), Vector2<float>(position.x + (length * 0.5f), position.y), color);
+	AddDebugLine(Vector2<float>(position.x, position.y - (length * 0.5f)), Vector2<float>(position.x, position.y + (length * 0.5f)), color);
+}
 
-			float nextAngle = step * (k + 1);
-			float x2 = cos(nextAngle);
-			float y2 = sin(nextAngle);
+// A one pixel wide quad along the line.
+void DebugDrawer::AddDebugLine(Vector2<float> startPosition, Vector2<float> endPosition, std::array<int, 4> color) {
+	const Vector2<float> direction = endPosition - startPosition;
+	const float length = direction.absolute();
+	const Vector2<float> side = length > 0.f ? Vector2<float>(-direction.y, direction.x) * (0.5f / length) : Vector2<float>(0.f, 0.5f);
+	DebugVertexBuffer& buffer = GetThreadBuffer();
+	const SDL_Color lineColor = ToColor(color);
+	const int first = (int)buffer.vertices.size();
+	PushVertex(buffer, startPosition + side, lineColor);
+	PushVertex(buffer, startPosition - side, lineColor);
+	PushVertex(buffer, endPosition + side, lineColor);
+	PushVertex(buffer, endPosition - side, lineColor);
+	buffer.indices.insert(buffer.indices.end(), { first, first + 1, first + 2, first + 1, first + 3, first + 2 });
+}
 
-			SDL_RenderDrawLine(
-				renderer,
-				x1 * _debugCircles[i].radius + _debugCircles[i].position.x,
-				y1 * _debugCircles[i].radius + _debugCircles[i].position.y,
-				x2 * _debugCircles[i].radius + _debugCircles[i].position.x,
-				y2 * _debugCircles[i].radius + _debugCircles[i].position.y);
+// With one thread's buffer filled it is submitted as is, otherwise the buffers are
+// appended into one with their indices offset.
+void DebugDrawer::Draw() {
+	std::lock_guard<std::mutex> lock(_threadBufferMutex);
+	_drawBuffers.clear();
+	for (unsigned int i = 0; i < _threadBuffers.size(); i++) {
+		std::shared_ptr<DebugVertexBuffer> threadBuffer = _threadBuffers[i].lock();
+		if (threadBuffer) {
+			_drawBuffers.emplace_back(std::move(threadBuffer));
+		}
+	}
+	// Buffers of threads that have exited.
+	if (_drawBuffers.size() < _threadBuffers.size()) {
+		_threadBuffers.erase(std::remove_if(_threadBuffers.begin(), _threadBuffers.end(),
+			[](const std::weak_ptr<DebugVertexBuffer>& threadBuffer) { return threadBuffer.expired(); }), _threadBuffers.end());
+	}
 
+	DebugVertexBuffer* submitBuffer = nullptr;
+	unsigned int filledBufferCount = 0;
+	for (unsigned int i = 0; i < _drawBuffers.size(); i++) {
+		if (!_drawBuffers[i]->indices.empty()) {
+			submitBuffer = _drawBuffers[i].get();
+			filledBufferCount++;
 		}
 	}
-	_debugCircles.clear();
+	if (filledBufferCount > 1) {
+		_mergedBuffer.vertices.clear();
+		_mergedBuffer.indices.clear();
+		for (unsigned int i = 0; i < _drawBuffers.size(); i++) {
+			const int indexOffset = (int)_mergedBuffer.vertices.size();
+			const DebugVertexBuffer& threadBuffer = *_drawBuffers[i];
+			_mergedBuffer.vertices.insert(_mergedBuffer.vertices.end(), threadBuffer.vertices.begin(), threadBuffer.vertices.end());
+			for (unsigned int k = 0; k < threadBuffer.indices.size(); k++) {
+				_mergedBuffer.indices.emplace_back(threadBuffer.indices[k] + indexOffset);
+			}
+		}
+		submitBuffer = &_mergedBuffer;
+	}
+
+	_lastVertexCount = 0;
+	if (submitBuffer) {
+		SDL_RenderGeometry(renderer, nullptr, submitBuffer->vertices.data(), (int)submitBuffer->vertices.size(),
+			submitBuffer->indices.data(), (int)submitBuffer->indices.size());
+		_lastVertexCount = submitBuffer->vertices.size();
+	}
+	for (unsigned int i = 0; i < _drawBuffers.size(); i++) {
+		_drawBuffers[i]->vertices.clear();
+		_drawBuffers[i]->indices.clear();
+	}
+	_drawBuffers.clear();
+}
+
+const unsigned int DebugDrawer::GetLastVertexCount() const {
+	return _lastVertexCount;
 }
 
-void DebugDrawer::DrawLines() {
-	for (int i = 0; i < _debugLines.size(); i++) {
-	SDL_SetRenderDrawColor(renderer, _debugBox[i].color[0], _debugBox[i].color[1], _debugBox[i].color[2], _debugBox[i].color[3]);
-		SDL_RenderDrawLineF(renderer, _debugLines[i].startPosition.x, _debugLines[i].startPosition.y, 
-			_debugLines[i].endPosition.x, _debugLines[i].endPosition.y);
+// Every thread registers one buffer per drawer the first time it adds something. The
+// thread_local keeps the buffer alive, adding for another drawer replaces it.
+DebugVertexBuffer& DebugDrawer::GetThreadBuffer() {
+	thread_local std::shared_ptr<DebugVertexBuffer> threadBuffer;
+	thread_local unsigned int threadDrawerId = 0;
+	if (threadDrawerId != _drawerId) {
+		threadBuffer = std::make_shared<DebugVertexBuffer>();
+		threadDrawerId = _drawerId;
+		std::lock_guard<std::mutex> lock(_threadBufferMutex);
+		_threadBuffers.emplace_back(threadBuffer);
 	}
-	_debugLines.clear();
+	return *threadBuffer;
 }
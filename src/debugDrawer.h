@@ -1,30 +1,31 @@
 #pragma once
 #include "vector2.h"
 
+#include <SDL2/SDL.h>
+
 #include <array>
+#include <memory>
+#include <mutex>
 #include <vector>
 
-struct DebugBox {
-	Vector2<float> min = Vector2<float>(0.f, 0.f);
-	Vector2<float> max = Vector2<float>(0.f, 0.f);
-	Vector2<float> position = Vector2<float>(0.f, 0.f);
-	std::array<int, 4> color = { 255, 255, 255, 255 };
-};
-struct DebugCircle {
-	Vector2<float> position = Vector2<float>(0.f, 0.f);
-	float radius = 0.f;
-	std::array<int, 4> color = { 255, 255, 255, 255 };
+// Outline triangles for one thread's debug primitives, built when they are added.
+struct DebugVertexBuffer {
+	std::vector<SDL_Vertex> vertices;
+	std::vector<int> indices;
 };
-struct DebugLine {
-	Vector2<float> startPosition = Vector2<float>(0.f, 0.f);
-	Vector2<float> endPosition = Vector2<float>(0, 0.f);
-	std::array<int, 4> color = { 255, 255, 255, 255 };
-};
-
 
+// Collects debug primitives as one pixel wide outlines in a coloured vertex buffer and
+// submits them with one SDL_RenderGeometry call per frame. Circles use the unit circle
+// table from fastTrig.h, so adding one doesn't evaluate any sin/cos.
+//
+// The Add functions can run on several threads at once, every thread writes its own
+// buffer. Draw must run on the render thread while nothing is being added.
+//
+// The buffers belong to their threads and the drawer only keeps weak references, so
+// a buffer goes away when its thread exits and Draw drops the expired entries.
 class DebugDrawer {
 public:
-	DebugDrawer() {}
+	DebugDrawer();
 	~DebugDrawer() {}
 
 	void AddDebugBox(Vector2<float> position, Vector2<float> min, Vector2<float> max, std::array<int, 4> color);
@@ -32,15 +33,22 @@ public:
 	void AddDebugCross(Vector2<float> position, float length, std::array<int, 4> color);
 	void AddDebugLine(Vector2<float> startPosition, Vector2<float> endPosition, std::array<int, 4> color);
 
-	void DrawBoxes();
-	void DrawCircles();
-	void DrawLines();
+	// Submits everything added since the last call and clears the buffers.
+	void Draw();
+
+	const unsigned int GetLastVertexCount() const;
 
 private:
+	DebugVertexBuffer& GetThreadBuffer();
 
-	std::vector<DebugBox> _debugBox;
-	std::vector<DebugLine> _debugLines;
-	std::vector<DebugCircle> _debugCircles;
+	std::vector<std::weak_ptr<DebugVertexBuffer>> _threadBuffers;
+	std::mutex _threadBufferMutex;
 
-};
+	// The live buffers while Draw runs, so none is freed before it was submitted.
+	std::vector<std::shared_ptr<DebugVertexBuffer>> _drawBuffers;
 
+	DebugVertexBuffer _mergedBuffer;
+
+	unsigned int _drawerId = 0;
+	unsigned int _lastVertexCount = 0;
+};
@@ -0,0 +1,117 @@
+#pragma once
+#include "dataStructuresAndMethods.h"
+#include "enemyBase.h"
+#include "gameEngine.h"
+#include "playerCharacter.h"
+#include "steeringBehaviour.h"
+
+// Behaviour shared by every enemy type, resolved at compile time through Derived.
+//
+// An enemy type derives from EnemyArchetype<Type> and defines:
+//   static constexpr EnemyType enemyType, const char* spritePath, float colliderRadius,
+//   int maxHealth and float movementSpeed
+//   void Init() that sets _weaponType, and void Update(float timeStep)
+//   const float GetAttackDamage() const, const float GetAttackRange() const
+// It can also hide Render and AddRenderItems to draw more than its sprite. Then it
+// gets an array in EnemyManager::EnemyArrays and a value in EnemyType.
+template<typename Derived>
+class EnemyArchetype : public EnemyBase {
+public:
+	EnemyArchetype(unsigned int objectID, Sprite* sprite);
+	~EnemyArchetype() {}
+
+	void ActivateEnemy(float orientation, Vector2<float> direction, Vector2<float> position);
+	void DeactivateEnemy();
+
+	void Render();
+	void AddRenderItems(std::vector<RenderItem>& renderItems) const;
+
+protected:
+	void QueryNeighbours();
+	void UpdateMovement(float timeStep);
+	void UpdateTarget();
+	void UpdateWeaponCooldown(float timeStep);
+
+	Derived& Self();
+	const Derived& Self() const;
+};
+
+template<typename Derived>
+inline EnemyArchetype<Derived>::EnemyArchetype(unsigned int objectID, Sprite* sprite) : EnemyBase(objectID) {
+	_sprite = sprite;
+
+	_position = Vector2<float>(-10000.f, -10000.f);
+
+	_circleCollider.radius = Derived::colliderRadius;
+	_circleCollider.position = _position;
+
+	_maxHealth = Derived::maxHealth;
+	_currentHealth = _maxHealth;
+	_movementSpeed = Derived::movementSpeed;
+
+	_enemyType = Derived::enemyType;
+}
+
+template<typename Derived>
+inline void EnemyArchetype<Derived>::ActivateEnemy(float orientation, Vector2<float> direction, Vector2<float> position) {
+	_orientation = orientation;
+	_direction = direction;
+	_position = position;
+	_circleCollider.position = _position;
+	Self().Init();
+}
+
+template<typename Derived>
+inline void EnemyArchetype<Derived>::DeactivateEnemy() {
+	_orientation = 0.f;
+	_direction = Vector2<float>(0.f, 0.f);
+	_position = Vector2<float>(-10000.f, -10000.f);
+	_circleCollider.position = _position;
+}
+
+template<typename Derived>
+inline void EnemyArchetype<Derived>::Render() {
+	_sprite->RenderWithOrientation(_position, _orientation);
+}
+
+template<typename Derived>
+inline void EnemyArchetype<Derived>::AddRenderItems(std::vector<RenderItem>& renderItems) const {
+	renderItems.push_back({ _sprite, _position, _orientation });
+}
+
+template<typename Derived>
+inline void EnemyArchetype<Derived>::QueryNeighbours() {
+	enemyManager->GetEnemyBroadphase()->Query(_circleCollider, _queriedEnemies);
+}
+
+template<typename Derived>
+inline void EnemyArchetype<Derived>::UpdateMovement(float timeStep) {
+	_direction = Vector2<float>(_targetPosition - _position).normalized();
+	_position += separationBehaviour->Steering(this).linearVelocity * timeStep;
+
+	if (!IsInDistance(_position, playerCharacter->GetPosition(), Self().GetAttackRange() * 0.5f)) {
+		_position += _direction * _movementSpeed * timeStep;
+		_circleCollider.position = _position;
+	}
+	_orientation = VectorAsOrientation(_direction);
+}
+
+template<typename Derived>
+inline void EnemyArchetype<Derived>::UpdateTarget() {
+	_targetPosition = playerCharacter->GetPosition();
+}
+
+template<typename Derived>
+inline void EnemyArchetype<Derived>::UpdateWeaponCooldown(float timeStep) {
+	_weaponCooldown -= timeStep;
+}
+
+template<typename Derived>
+inline Derived& EnemyArchetype<Derived>::Self() {
+	return static_cast<Derived&>(*this);
+}
+
+template<typename Derived>
+inline const Derived& EnemyArchetype<Derived>::Self() const {
+	return static_cast<const Derived&>(*this);
+}
@@ -1,3 +1,30 @@
 #include "enemyBase.h"
 #include "gameEngine.h"
-#include "playerCharacter.h"
\ No newline at end of file
+#include "playerCharacter.h"
+
+bool EnemyBase::TakeDamage(unsigned int damageAmount) {
+	_currentHealth -= damageAmount;
+	if (_currentHealth <= 0) {
+		return true;
+	}
+	return false;
+}
+
+float EnemyBase::AccumulateUpdateTime(float timeStep) {
+	_timeSinceUpdate += timeStep;
+	return _timeSinceUpdate;
+}
+
+void EnemyBase::ResetUpdateSchedule() {
+	_timeSinceUpdate = 0.f;
+	_updateTier = 0;
+}
+
+void EnemyBase::CompleteUpdate(unsigned int nextUpdateTier) {
+	_updateTier = nextUpdateTier;
+	_timeSinceUpdate = 0.f;
+}
+
+const unsigned int EnemyBase::GetUpdateTier() const {
+	return _updateTier;
+}
@@ -4,8 +4,8 @@
 #include "objectBase.h"
 #include "sprite.h"
 #include "vector2.h"
-
-class Timer;
+#include "weaponSystem.h"
+#include "worldSnapshot.h"
 
 enum class EnemyType {
 	Boar,
@@ -13,33 +13,34 @@ enum class EnemyType {
 	Count
 };
 
+// State every enemy type shares. Nothing in here is virtual, the behaviour of each
+// type lives in its archetype (see enemyArchetype.h) and is called on the concrete
+// type from the per-type arrays in EnemyManager.
 class EnemyBase : public ObjectBase {
 public:
 	EnemyBase(int objectID) : ObjectBase(objectID) {}
 	~EnemyBase() {}
 
-	virtual void Init() = 0;
-	virtual void Update() = 0;
-	virtual void Render() = 0;
-
-	virtual bool TakeDamage(unsigned int damageAmount) = 0;
-
-
-	virtual const Circle GetCollider() const = 0;
-	virtual const EnemyType GetEnemyType() const = 0;
-	virtual const float GetAttackDamage() const = 0;
-	virtual const float GetAttackRange() const = 0;
-	virtual const float GetOrientation() const = 0;
-	virtual const int GetCurrentHealth() const = 0;
-	virtual const unsigned int GetObjectID() const = 0;
-	virtual const Sprite* GetSprite() const = 0;
-	virtual const Vector2<float> GetPosition() const = 0;
-	virtual const std::shared_ptr<Timer> GetAttackTimer() const = 0;
-	virtual const std::vector<std::shared_ptr<EnemyBase>> GetQueriedEnemies() const = 0;
-	
-	virtual void ActivateEnemy(float orienation, Vector2<float> direction, Vector2<float> position) = 0;
-	virtual void DeactivateEnemy() = 0;
-	virtual void HandleAttack() = 0;
+	bool TakeDamage(unsigned int damageAmount);
+
+	const Circle GetCollider() const;
+	const EnemyType GetEnemyType() const;
+	const float GetOrientation() const;
+	const int GetCurrentHealth() const;
+	const unsigned int GetObjectID() const;
+	const Sprite* GetSprite() const;
+	const Vector2<float> GetPosition() const;
+	const std::vector<std::shared_ptr<EnemyBase>>& GetQueriedEnemies() const;
+
+	// The weapon is resolved by WeaponSystem, the enemy only counts its cooldown down.
+	const WeaponType GetWeaponType() const;
+	const bool IsWeaponReady() const;
+	void ResetWeaponCooldown();
+
+	float AccumulateUpdateTime(float timeStep);
+	void ResetUpdateSchedule();
+	void CompleteUpdate(unsigned int nextUpdateTier);
+	const unsigned int GetUpdateTier() const;
 
 protected:
 	Circle _circleCollider;	
@@ -47,16 +48,63 @@ protected:
 	int _currentHealth = 0;
 	int _maxHealth = 0;
 
-	std::shared_ptr<Timer> _attackTimer = nullptr;
-
 	Vector2<float> _targetPosition = Vector2<float>(0.f, 0.f);
 	Vector2<float> _direction = Vector2<float>(0.f, 0.f);
 
 	std::vector<std::shared_ptr<EnemyBase>> _queriedEnemies;
 
 	EnemyType _enemyType = EnemyType::Count;
+	WeaponType _weaponType = WeaponType::Count;
 
 	float _movementSpeed = 0.f;
+	float _weaponCooldown = 0.f;
+	float _timeSinceUpdate = 0.f;
+
+	unsigned int _updateTier = 0;
 
 };
 
+// The getters are called in the separation and collision loops, so they are kept inline.
+inline const Circle EnemyBase::GetCollider() const {
+	return _circleCollider;
+}
+
+inline const EnemyType EnemyBase::GetEnemyType() const {
+	return _enemyType;
+}
+
+inline const float EnemyBase::GetOrientation() const {
+	return _orientation;
+}
+
+inline const int EnemyBase::GetCurrentHealth() const {
+	return _currentHealth;
+}
+
+inline const unsigned int EnemyBase::GetObjectID() const {
+	return _objectID;
+}
+
+inline const Sprite* EnemyBase::GetSprite() const {
+	return _sprite;
+}
+
+inline const Vector2<float> EnemyBase::GetPosition() const {
+	return _position;
+}
+
+inline const WeaponType EnemyBase::GetWeaponType() const {
+	return _weaponType;
+}
+
+inline const bool EnemyBase::IsWeaponReady() const {
+	return _weaponCooldown <= 0.f;
+}
+
+inline void EnemyBase::ResetWeaponCooldown() {
+	_weaponCooldown = GetWeaponData(_weaponType).cooldown;
+}
+
+inline const std::vector<std::shared_ptr<EnemyBase>>& EnemyBase::GetQueriedEnemies() const {
+	return _queriedEnemies;
+}
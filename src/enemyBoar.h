@@ -1,41 +1,20 @@
 #pragma once
-#include "collision.h"
-#include "enemyBase.h"
-#include "sprite.h"
-#include "vector2.h"
+#include "enemyArchetype.h"
 
-class EnemyBoar : public EnemyBase {
+class EnemyBoar final : public EnemyArchetype<EnemyBoar> {
 public:
-	EnemyBoar(unsigned int objectID, int attackDamage, int maxHealth, float attackRange, float movementSpeed);
-	~EnemyBoar();
+	static constexpr EnemyType enemyType = EnemyType::Boar;
+	static constexpr const char* spritePath = "res/sprites/MadBoar.png";
+	static constexpr float colliderRadius = 16.f;
+	static constexpr int maxHealth = 20;
+	static constexpr float movementSpeed = 100.f;
 
-	void Init() override;
-	void Update() override;
-	void Render() override;
+	EnemyBoar(unsigned int objectID, Sprite* sprite);
+	~EnemyBoar() {}
 
-	bool TakeDamage(unsigned int damageAmount) override;
+	void Init();
+	void Update(float timeStep);
 
-	const Circle GetCollider() const override;
-	const EnemyType GetEnemyType() const override;
-	const float GetAttackDamage() const override;
-	const float GetAttackRange() const override;
-	const float GetOrientation() const override;
-	const int GetCurrentHealth() const override;
-	const unsigned int GetObjectID() const override;
-	const Sprite* GetSprite() const override;
-	const std::shared_ptr<Timer> GetAttackTimer() const override;
-	const Vector2<float> GetPosition() const override;
-	const std::vector<std::shared_ptr<EnemyBase>> GetQueriedEnemies() const override;
-
-	void ActivateEnemy(float orienation, Vector2<float> direction, Vector2<float> position) override;
-	void DeactivateEnemy() override;
-	void HandleAttack() override;
-
-private:
-	void UpdateMovement();
-	void UpdateTarget();
-	
-	float _attackRange = 0.f;
-	int _attackDamage = 0;
+	const float GetAttackDamage() const;
+	const float GetAttackRange() const;
 };
-
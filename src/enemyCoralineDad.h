@@ -1,43 +1,26 @@
 #pragma once
-#include "collision.h"
-#include "enemyBase.h"
-#include "sprite.h"
-#include "vector2.h"
+#include "enemyArchetype.h"
 
-class WeaponComponent;
-
-class EnemyCoralineDad : public EnemyBase {
+class EnemyCoralineDad final : public EnemyArchetype<EnemyCoralineDad> {
 public:
-	EnemyCoralineDad(unsigned int objectID, int maxHealth, float movementSpeed);
-	~EnemyCoralineDad();
+	static constexpr EnemyType enemyType = EnemyType::CoralineDad;
+	static constexpr const char* spritePath = "res/sprites/CoralineDad.png";
+	static constexpr float colliderRadius = 12.f;
+	static constexpr int maxHealth = 15;
+	static constexpr float movementSpeed = 75.f;
 
-	void Init() override;
-	void Update() override;
-	void Render() override;
+	EnemyCoralineDad(unsigned int objectID, Sprite* sprite);
+	~EnemyCoralineDad() {}
 
-	bool TakeDamage(unsigned int damageAmount) override;
+	void Init();
+	void Update(float timeStep);
 
-	const Circle GetCollider() const override;
-	const EnemyType GetEnemyType() const override;
-	const float GetAttackDamage() const override;
-	const float GetAttackRange() const override;
-	const float GetOrientation() const override;
-	const int GetCurrentHealth() const override;
-	const unsigned int GetObjectID() const override;
-	const Sprite* GetSprite() const override;
-	const std::shared_ptr<Timer> GetAttackTimer() const override;
-	const Vector2<float> GetPosition() const override;
-	const std::vector<std::shared_ptr<EnemyBase>> GetQueriedEnemies() const override;
+	void Render();
+	void AddRenderItems(std::vector<RenderItem>& renderItems) const;
 
-	void ActivateEnemy(float orienation, Vector2<float> direction, Vector2<float> position) override;
-	void DeactivateEnemy() override;
-	void HandleAttack() override;
+	const float GetAttackDamage() const;
+	const float GetAttackRange() const;
 
 private:
-	void UpdateMovement();
-	void UpdateTarget();
 	void PickWeapon();
-
-	std::shared_ptr<WeaponComponent> _weaponComponent = nullptr;
 };
-
@@ -1,25 +1,29 @@
 #include "enemyManager.h"
 
-#include "enemyBase.h"
+#include "aabbTree.h"
+#include "dataStructuresAndMethods.h"
 #include "enemyBoar.h"
 #include "enemyCoralineDad.h"
 #include "gameEngine.h"
+#include "imGuiManager.h"
 #include "objectPool.h"
 #include "playerCharacter.h"
 #include "quadTree.h"
 #include "timerManager.h"
-#include "weaponComponent.h"
 
 EnemyManager::EnemyManager() {
-	QuadTreeNode quadTreeNode;
-	quadTreeNode.rectangle = AABB::makeFromPositionSize(
-		Vector2(windowWidth * 0.5f, windowHeight * 0.5f), windowHeight, windowWidth);
-	_enemyQuadTree = std::make_shared<QuadTree<std::shared_ptr<EnemyBase>>>(quadTreeNode, 25);
-
-	for (unsigned int i = 0; i < (unsigned int)EnemyType::Count; i++) {
-		_enemyPools[(EnemyType)i] = std::make_shared<ObjectPool<std::shared_ptr<EnemyBase>>>(_enemyAmountLimit);
-	}
+	SetBroadphaseType(_broadphaseType);
+
+	ForEachEnemyArray([&](auto& enemyArray) {
+		using Enemy = typename std::decay_t<decltype(enemyArray)>::Enemy;
+		enemyArray.pool = std::make_shared<ObjectPool<std::shared_ptr<Enemy>>>(_enemyAmountLimit);
+		enemyArray.sprite = std::make_shared<Sprite>();
+		enemyArray.sprite->Load(Enemy::spritePath);
+	});
 	_numberOfEnemyTypes = (unsigned int)EnemyType::Count;
+
+	// Enemies spawn on the window edges and walk in, so a margin keeps them apart on the curve.
+	_mortonOrder.SetBounds({ -100.f, -100.f }, { windowWidth + 100.f, windowHeight + 100.f });
 }
 
 EnemyManager::~EnemyManager() {
@@ -37,186 +41,408 @@ void EnemyManager::Init() {
 }
 
 void EnemyManager::Update() {
-	if (_spawnTimer->GetTimerFinished() && _activeEnemies.size() < _enemyAmountLimit) {
+	if (_spawnTimer->GetTimerFinished() && GetActiveEnemyCount() + _spawnQueue.size() < _enemyAmountLimit) {
 		EnemySpawner();
 	}
-	for (unsigned i = 0; i < _activeEnemies.size(); i++) {
-		_activeEnemies[i]->Update();
+	ProcessSpawnQueue();
+
+	_tierPopulations.fill(0);
+	_skippedUpdates = 0;
+	unsigned int updatesRun = 0;
+	const Uint64 updateStart = SDL_GetPerformanceCounter();
+
+	ForEachEnemyArray([&](auto& enemyArray) {
+		updatesRun += UpdateEnemies(enemyArray);
+	});
+
+	_levelOfDetailTimeSaved = 0.f;
+	if (updatesRun > 0) {
+		const float updateTime = (float)(SDL_GetPerformanceCounter() - updateStart) * 1000.f / (float)SDL_GetPerformanceFrequency();
+		_levelOfDetailTimeSaved = updateTime / updatesRun * _skippedUpdates;
 	}
 }
 
 void EnemyManager::Render() {
-	for (unsigned i = 0; i < _activeEnemies.size(); i++) {
-		_activeEnemies[i]->Render();
-	}
+	ForEachEnemyArray([&](auto& enemyArray) {
+		for (unsigned int i = 0; i < enemyArray.activeEnemies.size(); i++) {
+			enemyArray.activeEnemies[i]->Render();
+		}
+	});
+}
+
+void EnemyManager::AddRenderItems(std::vector<RenderItem>& renderItems) const {
+	ForEachEnemyArray([&](const auto& enemyArray) {
+		for (unsigned int i = 0; i < enemyArray.activeEnemies.size(); i++) {
+			enemyArray.activeEnemies[i]->AddRenderItems(renderItems);
+		}
+	});
+}
+
+void EnemyManager::UpdateImgui() {
+	std::lock_guard<std::mutex> lock(_imguiMutex);
+	float spawnBudgetCount = (float)_imguiSettings.spawnBudgetCount;
+	imGuiHandler->SliderFloat("Enemy spawning", "Spawns per frame", spawnBudgetCount, 1.f, 100.f);
+	_imguiSettings.spawnBudgetCount = (unsigned int)spawnBudgetCount;
+	imGuiHandler->SliderFloat("Enemy spawning", "Budget (ms)", _imguiSettings.spawnBudgetTime, 0.1f, 10.f);
+	imGuiHandler->ShowIntValue("Enemy spawning", "Queue depth", _imguiStatistics.spawnQueueDepth);
+	imGuiHandler->ShowFloatValue("Enemy spawning", "Spawn cost (ms)", _imguiStatistics.spawnCostLastFrame);
+
+	std::array<float, updateTierCount - 1>& tierDistances = _imguiSettings.tierDistances;
+	imGuiHandler->Checkbox("Enemy LOD", "Enabled", _imguiSettings.levelOfDetailEnabled);
+	imGuiHandler->SliderFloat("Enemy LOD", "Near distance", tierDistances[0], 0.f, tierDistances[1]);
+	imGuiHandler->SliderFloat("Enemy LOD", "Far distance", tierDistances[1], tierDistances[0], 1000.f);
+	imGuiHandler->ShowIntValue("Enemy LOD", "Tier 0 (every tick)", _imguiStatistics.tierPopulations[0]);
+	imGuiHandler->ShowIntValue("Enemy LOD", "Tier 1 (every 2nd tick)", _imguiStatistics.tierPopulations[1]);
+	imGuiHandler->ShowIntValue("Enemy LOD", "Tier 2 (every 4th tick)", _imguiStatistics.tierPopulations[2]);
+	imGuiHandler->ShowIntValue("Enemy LOD", "Skipped updates", _imguiStatistics.skippedUpdates);
+	imGuiHandler->ShowFloatValue("Enemy LOD", "Time saved (ms)", _imguiStatistics.levelOfDetailTimeSaved);
+
+	float spatialSortInterval = (float)_imguiSettings.spatialSortInterval;
+	imGuiHandler->Checkbox("Spatial sort", "Sort enemies", _imguiSettings.spatialSortEnabled);
+	imGuiHandler->SliderFloat("Spatial sort", "Enemy interval (ticks)", spatialSortInterval, 1.f, 120.f);
+	_imguiSettings.spatialSortInterval = (unsigned int)spatialSortInterval;
+	imGuiHandler->ShowFloatValue("Spatial sort", "Enemy sort (ms)", _imguiStatistics.spatialSortTime);
+}
+
+void EnemyManager::SyncImgui() {
+	std::lock_guard<std::mutex> lock(_imguiMutex);
+	_settings = _imguiSettings;
+	_imguiStatistics.tierPopulations = _tierPopulations;
+	_imguiStatistics.levelOfDetailTimeSaved = _levelOfDetailTimeSaved;
+	_imguiStatistics.spawnCostLastFrame = _spawnCostLastFrame;
+	_imguiStatistics.spatialSortTime = _spatialSortTime;
+	_imguiStatistics.skippedUpdates = _skippedUpdates;
+	_imguiStatistics.spawnQueueDepth = _spawnQueue.size();
 }
 
 std::vector<std::shared_ptr<EnemyBase>> EnemyManager::GetActiveEnemies() {
-	return _activeEnemies;
+	std::vector<std::shared_ptr<EnemyBase>> activeEnemies;
+	ForEachEnemyArray([&](auto& enemyArray) {
+		activeEnemies.insert(activeEnemies.end(), enemyArray.activeEnemies.begin(), enemyArray.activeEnemies.end());
+	});
+	return activeEnemies;
 }
 
-std::shared_ptr<QuadTree<std::shared_ptr<EnemyBase>>> EnemyManager::GetEnemyQuadTree() {
-	return _enemyQuadTree;
+std::shared_ptr<Broadphase<std::shared_ptr<EnemyBase>>> EnemyManager::GetEnemyBroadphase() {
+	return _enemyBroadphase;
 }
 
-void EnemyManager::ClearEnemyQuadTree() {
-	_enemyQuadTree->Clear();
+const std::vector<std::shared_ptr<EnemyBase>>& EnemyManager::GetBroadphaseEnemies() const {
+	return _broadphaseEnemies;
 }
 
-void EnemyManager::CreateNewEnemy(EnemyType enemyType, float orientation, Vector2<float> direction, Vector2<float> position) {
-	switch (enemyType) {
-	case EnemyType::Boar:
-		_enemyPools[enemyType]->PoolObject(std::make_shared<EnemyBoar>(_lastEnemyID, 1, 20, 15.f, 100.f));
+void EnemyManager::SetBroadphaseType(BroadphaseType broadphaseType) {
+	QuadTreeNode quadTreeNode;
+	quadTreeNode.rectangle = AABB::makeFromPositionSize(
+		Vector2(windowWidth * 0.5f, windowHeight * 0.5f), windowHeight, windowWidth);
+	switch (broadphaseType) {
+	case BroadphaseType::QuadTree:
+		_enemyBroadphase = std::make_shared<QuadTree<std::shared_ptr<EnemyBase>>>(quadTreeNode, 25);
 		break;
 
-	case EnemyType::CoralineDad:
-		_enemyPools[enemyType]->PoolObject(std::make_shared<EnemyCoralineDad>(_lastEnemyID, 15, 75.f));
+	case BroadphaseType::AABBTree:
+		_enemyBroadphase = std::make_shared<AABBTree<std::shared_ptr<EnemyBase>>>(8.f);
 		break;
-	
+
 	default:
+		_enemyBroadphase = std::make_shared<QuadTree<std::shared_ptr<EnemyBase>>>(quadTreeNode, 25, 2.f);
 		break;
 	}
+	_broadphaseType = broadphaseType;
+}
+
+const BroadphaseType EnemyManager::GetBroadphaseType() const {
+	return _broadphaseType;
+}
+
+unsigned int EnemyManager::GetActiveEnemyCount(EnemyType enemyType) {
+	unsigned int activeCount = 0;
+	ForEachEnemyArray([&](auto& enemyArray) {
+		using Enemy = typename std::decay_t<decltype(enemyArray)>::Enemy;
+		if (Enemy::enemyType == enemyType) {
+			activeCount = enemyArray.activeEnemies.size();
+		}
+	});
+	return activeCount;
+}
+
+unsigned int EnemyManager::GetPooledEnemyCount(EnemyType enemyType) {
+	unsigned int pooledCount = 0;
+	ForEachEnemyArray([&](auto& enemyArray) {
+		using Enemy = typename std::decay_t<decltype(enemyArray)>::Enemy;
+		if (Enemy::enemyType == enemyType) {
+			pooledCount = enemyArray.pool->PoolSize();
+		}
+	});
+	return pooledCount;
+}
+
+const unsigned int EnemyManager::GetActiveEnemyCount() const {
+	unsigned int activeCount = 0;
+	ForEachEnemyArray([&](const auto& enemyArray) {
+		activeCount += enemyArray.activeEnemies.size();
+	});
+	return activeCount;
+}
+
+void EnemyManager::ClearEnemyQuadTree() {
+	_enemyBroadphase->Clear();
+}
+
+void EnemyManager::CreateNewEnemy(EnemyType enemyType, float orientation, Vector2<float> direction, Vector2<float> position) {
+	ForEachEnemyArray([&](auto& enemyArray) {
+		using Enemy = typename std::decay_t<decltype(enemyArray)>::Enemy;
+		if (Enemy::enemyType == enemyType) {
+			enemyArray.pool->PoolObject(std::make_shared<Enemy>(_lastEnemyID, enemyArray.sprite.get()));
+		}
+	});
+	_activeIndices.emplace_back(-1);
 	_lastEnemyID ++;
 }
 
 void EnemyManager::EnemySpawner() {
-	for (unsigned int i = 0; i < _spawnNumberOfEnemies; i++) {
-		std::uniform_int_distribution dist{ 0, 1 };
-		Vector2<float> spawnPosition = { 0.f, 0.f };
-
-		if (i < _spawnNumberOfEnemies * 0.5f) {
-			float distX = 0.f;
-			std::uniform_real_distribution<float> distY{ 0.f, windowHeight };
-			int temp = dist(randomEngine);
-			if (temp == 0) {
-				distX = 0;
-			} else {
-				distX = windowWidth;
-			}
-			spawnPosition = { distX, distY(randomEngine) };
-
+	const unsigned int spawnCount = std::min<unsigned int>(_spawnNumberOfEnemies,
+		_enemyAmountLimit - GetActiveEnemyCount() - _spawnQueue.size());
+
+	std::uniform_int_distribution dist{ 0, 1 };
+	std::uniform_real_distribution<float> distX{ 0.f, windowWidth };
+	std::uniform_real_distribution<float> distY{ 0.f, windowHeight };
+	for (unsigned int i = 0; i < spawnCount; i++) {
+		SpawnRequest spawnRequest;
+		if (i < spawnCount * 0.5f) {
+			spawnRequest.position = { dist(randomEngine) == 0 ? 0.f : windowWidth, distY(randomEngine) };
 		} else {
-			std::uniform_real_distribution<float> distX{ 0.f, windowWidth };
-			float distY = 0.f;
-			int temp = dist(randomEngine);
-			if (temp == 0) {
-				distY = 0;
-			} else {
-				distY = windowHeight;
-			}
-			spawnPosition = { distX(randomEngine), distY };
+			spawnRequest.position = { distX(randomEngine), dist(randomEngine) == 0 ? 0.f : windowHeight };
 		}
 		if (i % 3 == 0) {
-			enemyManager->SpawnEnemy(EnemyType::Boar, 0.f, Vector2<float>(0.f, 0.f), spawnPosition);
+			spawnRequest.enemyType = EnemyType::Boar;
 		} else {
-			enemyManager->SpawnEnemy(EnemyType::CoralineDad, 0.f, Vector2<float>(0.f, 0.f), spawnPosition);
+			spawnRequest.enemyType = EnemyType::CoralineDad;
 		}
-
+		_spawnQueue.emplace_back(spawnRequest);
 	}
 	_spawnTimer->ResetTimer();
 }
 
-void EnemyManager::SpawnEnemy(EnemyType enemyType, float orientation,
-	Vector2<float> direction, Vector2<float> position) {
-	if (_enemyPools[enemyType]->IsEmpty()) {
-		CreateNewEnemy(enemyType, orientation, direction, position);
+void EnemyManager::ProcessSpawnQueue() {
+	_spawnedLastFrame = 0;
+	_spawnCostLastFrame = 0.f;
+	if (_spawnQueue.empty()) {
+		return;
+	}
+	const Uint64 spawnStart = SDL_GetPerformanceCounter();
+	const float ticksToMilliseconds = 1000.f / (float)SDL_GetPerformanceFrequency();
+
+	// Always spawn at least one enemy per frame so the queue drains even over budget.
+	while (!_spawnQueue.empty() && _spawnedLastFrame < _settings.spawnBudgetCount && GetActiveEnemyCount() < _enemyAmountLimit) {
+		SpawnEnemy(_spawnQueue.front().enemyType, 0.f, Vector2<float>(0.f, 0.f), _spawnQueue.front().position);
+		_spawnQueue.pop_front();
+		_spawnedLastFrame++;
+
+		_spawnCostLastFrame = (float)(SDL_GetPerformanceCounter() - spawnStart) * ticksToMilliseconds;
+		if (_spawnCostLastFrame >= _settings.spawnBudgetTime) {
+			break;
+		}
 	}
-	_activeEnemies.emplace_back(_enemyPools[enemyType]->SpawnObject());
-	_activeEnemies.back()->ActivateEnemy(orientation, direction, position);
 }
 
-void EnemyManager::RemoveAllEnemies() {
-	while (_activeEnemies.size() > 0) {
-		_activeEnemies.back()->DeactivateEnemy();
-		_enemyPools[_activeEnemies.back()->GetEnemyType()]->PoolObject(_activeEnemies.back());
-		_activeEnemies.pop_back();
+void EnemyManager::SetLevelOfDetailEnabled(bool levelOfDetailEnabled) {
+	std::lock_guard<std::mutex> lock(_imguiMutex);
+	_settings.levelOfDetailEnabled = levelOfDetailEnabled;
+	_imguiSettings.levelOfDetailEnabled = levelOfDetailEnabled;
+}
+
+const unsigned int EnemyManager::GetTierPopulation(unsigned int updateTier) const {
+	return _tierPopulations[updateTier];
+}
+
+const unsigned int EnemyManager::GetSkippedUpdates() const {
+	return _skippedUpdates;
+}
+
+const float EnemyManager::GetLevelOfDetailTimeSaved() const {
+	return _levelOfDetailTimeSaved;
+}
+
+template<typename T>
+unsigned int EnemyManager::SelectUpdateTier(const T& enemy) {
+	const Vector2<float> playerPosition = playerCharacter->GetPosition();
+	// Enemies standing still inside their attack range only need to check the attack timer.
+	if (IsInDistance(enemy.GetPosition(), playerPosition, enemy.GetAttackRange() * 0.5f)) {
+		return 1;
 	}
-	_spawnTimer->ResetTimer();
+	if (IsInDistance(enemy.GetPosition(), playerPosition, _settings.tierDistances[0])) {
+		return 0;
+	}
+	if (IsInDistance(enemy.GetPosition(), playerPosition, _settings.tierDistances[1])) {
+		return 1;
+	}
+	return 2;
 }
 
-void EnemyManager::RemoveEnemy(EnemyType enemyType, unsigned int objectID) {
-	if (_activeEnemies.empty()) {
-		return;
-	} else if (_activeEnemies.size() > 1) {
-		QuickSort(0, _activeEnemies.size() - 1);
-		_latestEnemyIndex = BinarySearch(0, _activeEnemies.size() - 1, objectID);
-		if (_latestEnemyIndex >= 0) {
-			_activeEnemies[_latestEnemyIndex]->DeactivateEnemy();
-			_enemyPools[enemyType]->PoolObject(_activeEnemies[_latestEnemyIndex]);
-			std::swap(_activeEnemies[_latestEnemyIndex], _activeEnemies.back());
+// Tiers further away update every n-th tick. The object ID staggers each tier
+// over its interval so the same share of a tier is updated on every tick.
+template<typename T>
+unsigned int EnemyManager::UpdateEnemies(EnemyArray<T>& enemyArray) {
+	unsigned int updatesRun = 0;
+	for (unsigned int i = 0; i < enemyArray.activeEnemies.size(); i++) {
+		T& enemy = *enemyArray.activeEnemies[i];
+		const float timeStep = enemy.AccumulateUpdateTime(deltaTime);
+		const unsigned int updateTier = _settings.levelOfDetailEnabled ? enemy.GetUpdateTier() : 0;
+		_tierPopulations[updateTier]++;
+
+		if ((frameNumber + enemy.GetObjectID()) % _tierIntervals[updateTier] != 0) {
+			_skippedUpdates++;
+			continue;
 		}
-		_latestEnemyIndex = -1;
+		enemy.Update(timeStep);
+		enemy.CompleteUpdate(_settings.levelOfDetailEnabled ? SelectUpdateTier(enemy) : 0);
+		updatesRun++;
 	}
-	_activeEnemies.pop_back();
+	return updatesRun;
 }
 
-void EnemyManager::TakeDamage(unsigned int enemyIndex, unsigned int damageAmount) {
-	if(_activeEnemies[enemyIndex]->TakeDamage(damageAmount)) {
-		RemoveEnemy(_activeEnemies[enemyIndex]->GetEnemyType(), enemyIndex);
-	}
+const unsigned int EnemyManager::GetSpawnQueueDepth() const {
+	return _spawnQueue.size();
 }
 
-void EnemyManager::UpdateQuadTree() {
-	for (unsigned i = 0; i < _activeEnemies.size(); i++) {
-		_enemyQuadTree->Insert(_activeEnemies[i], _activeEnemies[i]->GetCollider());
-	}
+const unsigned int EnemyManager::GetSpawnedLastFrame() const {
+	return _spawnedLastFrame;
 }
 
-int EnemyManager::BinarySearch(int low, int high, int objectID) {
-	while (low <= high) {
-		int mid = low + (high - low) / 2;
+const float EnemyManager::GetSpawnCostLastFrame() const {
+	return _spawnCostLastFrame;
+}
 
-		if (_activeEnemies[mid]->GetObjectID() == objectID) {
-			return mid;
+void EnemyManager::SpawnEnemy(EnemyType enemyType, float orientation,
+	Vector2<float> direction, Vector2<float> position) {
+	ForEachEnemyArray([&](auto& enemyArray) {
+		using Enemy = typename std::decay_t<decltype(enemyArray)>::Enemy;
+		if (Enemy::enemyType != enemyType) {
+			return;
 		}
-
-		if (_activeEnemies[mid]->GetObjectID() < objectID) {
-			low = mid + 1;
-		} else {
-			high = mid - 1;
+		if (enemyArray.pool->IsEmpty()) {
+			CreateNewEnemy(enemyType, orientation, direction, position);
 		}
-	}
-	return -1;
+		enemyArray.activeEnemies.emplace_back(enemyArray.pool->SpawnObject());
+		enemyArray.activeEnemies.back()->ActivateEnemy(orientation, direction, position);
+		enemyArray.activeEnemies.back()->ResetUpdateSchedule();
+		_activeIndices[enemyArray.activeEnemies.back()->GetObjectID()] = enemyArray.activeEnemies.size() - 1;
+	});
 }
 
-int EnemyManager::Partition(int start, int end) {
-	int pivot = _activeEnemies[start]->GetObjectID();
-
-	int count = 0;
-	for (int i = start + 1; i <= end; i++) {
-		if (_activeEnemies[i]->GetObjectID() <= pivot) {
-			count++;
+void EnemyManager::RemoveAllEnemies() {
+	ForEachEnemyArray([&](auto& enemyArray) {
+		while (enemyArray.activeEnemies.size() > 0) {
+			_activeIndices[enemyArray.activeEnemies.back()->GetObjectID()] = -1;
+			enemyArray.activeEnemies.back()->DeactivateEnemy();
+			enemyArray.pool->PoolObject(enemyArray.activeEnemies.back());
+			enemyArray.activeEnemies.pop_back();
 		}
-	}
+	});
+	_broadphaseEnemies.clear();
+	_spawnQueue.clear();
+	_spawnTimer->ResetTimer();
+}
 
-	int pivotIndex = start + count;
-	std::swap(_activeEnemies[pivotIndex], _activeEnemies[start]);
+void EnemyManager::RemoveEnemy(EnemyType enemyType, unsigned int objectID) {
+	if (objectID >= _activeIndices.size() || _activeIndices[objectID] < 0) {
+		return;
+	}
+	ForEachEnemyArray([&](auto& enemyArray) {
+		using Enemy = typename std::decay_t<decltype(enemyArray)>::Enemy;
+		if (Enemy::enemyType != enemyType) {
+			return;
+		}
+		std::vector<std::shared_ptr<Enemy>>& activeEnemies = enemyArray.activeEnemies;
+		const int enemyIndex = _activeIndices[objectID];
+		activeEnemies[enemyIndex]->DeactivateEnemy();
+		enemyArray.pool->PoolObject(activeEnemies[enemyIndex]);
+
+		_activeIndices[activeEnemies.back()->GetObjectID()] = enemyIndex;
+		_activeIndices[objectID] = -1;
+		std::swap(activeEnemies[enemyIndex], activeEnemies.back());
+		activeEnemies.pop_back();
+	});
+}
 
-	int i = start, k = end;
+void EnemyManager::PrepareDamageSlots() {
+	if (_accumulatedDamage.size() < (unsigned int)_lastEnemyID) {
+		_accumulatedDamage = std::vector<std::atomic<unsigned int>>(_lastEnemyID);
+	}
+}
 
-	while (i < pivotIndex && k > pivotIndex) {
+void EnemyManager::AccumulateDamage(unsigned int objectID, unsigned int damageAmount) {
+	_accumulatedDamage[objectID].fetch_add(damageAmount, std::memory_order_relaxed);
+}
 
-		while (_activeEnemies[i]->GetObjectID() <= pivot) {
-			i++;
+void EnemyManager::ResolveAccumulatedDamage() {
+	// Only enemies in the broadphase can be hit. Deaths are collected first since
+	// RemoveEnemy reorders the active enemies.
+	_killedEnemies.clear();
+	for (unsigned int i = 0; i < _broadphaseEnemies.size(); i++) {
+		const unsigned int damageAmount = _accumulatedDamage[_broadphaseEnemies[i]->GetObjectID()].exchange(0, std::memory_order_relaxed);
+		if (damageAmount > 0 && _broadphaseEnemies[i]->TakeDamage(damageAmount)) {
+			_killedEnemies.emplace_back(_broadphaseEnemies[i]);
 		}
+	}
+	for (unsigned int i = 0; i < _killedEnemies.size(); i++) {
+		RemoveEnemy(_killedEnemies[i]->GetEnemyType(), _killedEnemies[i]->GetObjectID());
+	}
+}
 
-		while (_activeEnemies[k]->GetObjectID() > pivot) {
-			k--;
+void EnemyManager::UpdateQuadTree() {
+	_broadphaseEnemies.clear();
+	_enemyColliders.clear();
+	ForEachEnemyArray([&](auto& enemyArray) {
+		for (unsigned int i = 0; i < enemyArray.activeEnemies.size(); i++) {
+			_broadphaseEnemies.emplace_back(enemyArray.activeEnemies[i]);
+			_enemyColliders.emplace_back(enemyArray.activeEnemies[i]->GetCollider());
 		}
+	});
+	_enemyBroadphase->Build(_broadphaseEnemies, _enemyColliders);
+}
 
-		if (i < pivotIndex && k > pivotIndex) {
-			std::swap(_activeEnemies[i++], _activeEnemies[k--]);
-		}
+void EnemyManager::UpdateSpatialOrder() {
+	if (!_settings.spatialSortEnabled || frameNumber % _settings.spatialSortInterval != 0) {
+		return;
 	}
-	return pivotIndex;
+	const Uint64 sortStart = SDL_GetPerformanceCounter();
+	ForEachEnemyArray([&](auto& enemyArray) {
+		SortEnemies(enemyArray);
+	});
+	_spatialSortTime = (float)(SDL_GetPerformanceCounter() - sortStart) * 1000.f / (float)SDL_GetPerformanceFrequency();
+}
+
+void EnemyManager::SetSpatialSortEnabled(bool spatialSortEnabled) {
+	std::lock_guard<std::mutex> lock(_imguiMutex);
+	_settings.spatialSortEnabled = spatialSortEnabled;
+	_imguiSettings.spatialSortEnabled = spatialSortEnabled;
+}
+
+const float EnemyManager::GetSpatialSortTime() const {
+	return _spatialSortTime;
 }
 
-void EnemyManager::QuickSort(int start, int end) {
-	if (start >= end) {
+// Each type array is sorted on its own, so the per-type update loops walk it in curve order.
+template<typename T>
+void EnemyManager::SortEnemies(EnemyArray<T>& enemyArray) {
+	std::vector<std::shared_ptr<T>>& activeEnemies = enemyArray.activeEnemies;
+	if (activeEnemies.size() < 2) {
 		return;
 	}
-	int p = Partition(start, end);
+	_enemyPositions.clear();
+	for (unsigned int i = 0; i < activeEnemies.size(); i++) {
+		_enemyPositions.emplace_back(activeEnemies[i]->GetPosition());
+	}
+	const std::vector<unsigned int>& order = _mortonOrder.Sort(_enemyPositions);
 
-	QuickSort(start, p - 1);
-	QuickSort(p + 1, end);
+	enemyArray.sortedEnemies.clear();
+	for (unsigned int i = 0; i < order.size(); i++) {
+		enemyArray.sortedEnemies.emplace_back(std::move(activeEnemies[order[i]]));
+	}
+	activeEnemies.swap(enemyArray.sortedEnemies);
+	for (unsigned int i = 0; i < activeEnemies.size(); i++) {
+		_activeIndices[activeEnemies[i]->GetObjectID()] = i;
+	}
 }
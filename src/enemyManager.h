@@ -1,18 +1,47 @@
 #pragma once
-#include "quadTree.h"
+#include "broadphase.h"
+#include "mortonOrder.h"
 #include "vector2.h"
+#include "worldSnapshot.h"
 
+#include <array>
+#include <atomic>
+#include <deque>
 #include <vector>
-#include <unordered_map>
 #include <memory>
+#include <mutex>
+#include <tuple>
 
 class EnemyBase;
+class EnemyBoar;
+class EnemyCoralineDad;
 class Timer;
+struct Sprite;
 template<typename T> class ObjectPool;
-template<typename T> class QuadTree;
+template<typename T> class Broadphase;
 
 enum class EnemyType;
 
+// Active and pooled enemies of one type, so each type is updated in its own loop
+// without virtual calls.
+template<typename T>
+struct EnemyArray {
+	using Enemy = T;
+
+	std::vector<std::shared_ptr<T>> activeEnemies;
+	std::shared_ptr<ObjectPool<std::shared_ptr<T>>> pool = nullptr;
+
+	std::vector<std::shared_ptr<T>> sortedEnemies;
+
+	// Loaded once on the render thread and shared by every enemy of the type.
+	std::shared_ptr<Sprite> sprite = nullptr;
+};
+
+struct SpawnRequest {
+	EnemyType enemyType;
+	Vector2<float> position = Vector2<float>(0.f, 0.f);
+};
+
 class EnemyManager {
 public:
 	EnemyManager();
@@ -21,9 +50,20 @@ public:
 	void Init();
 	void Update();
 	void Render();
+	void AddRenderItems(std::vector<RenderItem>& renderItems) const;
+	void UpdateImgui();
+	// Applies what the overlay changed and copies what it shows, once per tick on
+	// the simulation thread.
+	void SyncImgui();
 
 	std::vector<std::shared_ptr<EnemyBase>> GetActiveEnemies();
-	std::shared_ptr<QuadTree<std::shared_ptr<EnemyBase>>> GetEnemyQuadTree();
+	std::shared_ptr<Broadphase<std::shared_ptr<EnemyBase>>> GetEnemyBroadphase();
+	const std::vector<std::shared_ptr<EnemyBase>>& GetBroadphaseEnemies() const;
+	void SetBroadphaseType(BroadphaseType broadphaseType);
+	const BroadphaseType GetBroadphaseType() const;
+
+	unsigned int GetActiveEnemyCount(EnemyType enemyType);
+	unsigned int GetPooledEnemyCount(EnemyType enemyType);
 
 	void ClearEnemyQuadTree();
 
@@ -31,7 +71,16 @@ public:
 		Vector2<float> direction, Vector2<float> position);
 
 	void EnemySpawner();
+	void ProcessSpawnQueue();
+
+	void SetLevelOfDetailEnabled(bool levelOfDetailEnabled);
+	const unsigned int GetTierPopulation(unsigned int updateTier) const;
+	const unsigned int GetSkippedUpdates() const;
+	const float GetLevelOfDetailTimeSaved() const;
 
+	const unsigned int GetSpawnQueueDepth() const;
+	const unsigned int GetSpawnedLastFrame() const;
+	const float GetSpawnCostLastFrame() const;
 
 	void SpawnEnemy(EnemyType enemyType, float orientation,
 		Vector2<float> direction, Vector2<float> position);
@@ -39,29 +88,114 @@ public:
 	void RemoveAllEnemies();
 	void RemoveEnemy(EnemyType enemyType, unsigned int objectID);
 
-	void TakeDamage(unsigned int enemyIndex, unsigned int damageAmount);
+	// Damage from the parallel collision pass is summed per enemy and applied in
+	// one step afterwards, so the outcome doesn't depend on thread timing.
+	void PrepareDamageSlots();
+	void AccumulateDamage(unsigned int objectID, unsigned int damageAmount);
+	void ResolveAccumulatedDamage();
 
 	void UpdateQuadTree();
 
-	int BinarySearch(int low, int high, int objectID);
+	// Every few ticks the active enemies are reordered along a Z-order curve, so
+	// enemies close to each other are updated and queried one after another.
+	void UpdateSpatialOrder();
+	void SetSpatialSortEnabled(bool spatialSortEnabled);
+	const float GetSpatialSortTime() const;
 
-	int Partition(int start, int end);
-	void QuickSort( int start, int end);
+	static const unsigned int updateTierCount = 3;
 
 private:
-	std::shared_ptr<QuadTree<std::shared_ptr<EnemyBase>>> _enemyQuadTree;
-
-	std::vector<std::shared_ptr<EnemyBase>> _activeEnemies;
+	// Tunables the overlay can change while the simulation thread ticks.
+	struct Settings {
+		std::array<float, updateTierCount - 1> tierDistances = { 200.f, 400.f };
+		float spawnBudgetTime = 1.f;
+		unsigned int spawnBudgetCount = 5;
+		unsigned int spatialSortInterval = 30;
+		bool levelOfDetailEnabled = true;
+		bool spatialSortEnabled = true;
+	};
+
+	// The values the overlay shows, as of the last tick.
+	struct ImguiStatistics {
+		std::array<unsigned int, updateTierCount> tierPopulations = {};
+		float levelOfDetailTimeSaved = 0.f;
+		float spawnCostLastFrame = 0.f;
+		float spatialSortTime = 0.f;
+		unsigned int skippedUpdates = 0;
+		unsigned int spawnQueueDepth = 0;
+	};
+
+	// One array per enemy type, a new type is added here.
+	using EnemyArrays = std::tuple<EnemyArray<EnemyBoar>, EnemyArray<EnemyCoralineDad>>;
+
+	template<typename Function>
+	void ForEachEnemyArray(Function&& function);
+	template<typename Function>
+	void ForEachEnemyArray(Function&& function) const;
+
+	template<typename T>
+	unsigned int UpdateEnemies(EnemyArray<T>& enemyArray);
+	template<typename T>
+	void SortEnemies(EnemyArray<T>& enemyArray);
+	template<typename T>
+	unsigned int SelectUpdateTier(const T& enemy);
+
+	const unsigned int GetActiveEnemyCount() const;
+
+	std::shared_ptr<Broadphase<std::shared_ptr<EnemyBase>>> _enemyBroadphase;
+	BroadphaseType _broadphaseType = BroadphaseType::LooseQuadTree;
+
+	EnemyArrays _enemyArrays;
+
+	// Every active enemy in array order, as they were inserted into the broadphase this tick.
+	std::vector<std::shared_ptr<EnemyBase>> _broadphaseEnemies;
+	std::vector<Circle> _enemyColliders;
+
+	// Index into the enemy's type array by object ID, -1 while the enemy is pooled.
+	std::vector<int> _activeIndices;
+
+	MortonOrder _mortonOrder;
+	std::vector<Vector2<float>> _enemyPositions;
 
 	std::shared_ptr<Timer> _spawnTimer = nullptr;
 
-	std::unordered_map<EnemyType, std::shared_ptr<ObjectPool<std::shared_ptr<EnemyBase>>>> _enemyPools;
+	std::deque<SpawnRequest> _spawnQueue;
+
+	// One slot per enemy object ID.
+	std::vector<std::atomic<unsigned int>> _accumulatedDamage;
+	std::vector<std::shared_ptr<EnemyBase>> _killedEnemies;
+
+	std::array<unsigned int, updateTierCount> _tierIntervals = { 1, 2, 4 };
+	std::array<unsigned int, updateTierCount> _tierPopulations = {};
+
+	// The simulation reads _settings, the overlay edits _imguiSettings and reads
+	// _imguiStatistics. SyncImgui exchanges them under _imguiMutex.
+	Settings _settings;
+	Settings _imguiSettings;
+	ImguiStatistics _imguiStatistics;
+	std::mutex _imguiMutex;
+
+	float _levelOfDetailTimeSaved = 0.f;
+	unsigned int _skippedUpdates = 0;
+
+	float _spawnCostLastFrame = 0.f;
+	float _spatialSortTime = 0.f;
 
 	int _lastEnemyID = 0;
-	int _latestEnemyIndex = -1;
 
 	unsigned int _enemyAmountLimit = 1000;
 	unsigned int _numberOfEnemyTypes = 0;
 	unsigned int _spawnNumberOfEnemies = 25;
+	unsigned int _spawnedLastFrame = 0;
 };
 
+
+template<typename Function>
+inline void EnemyManager::ForEachEnemyArray(Function&& function) {
+	std::apply([&](auto&... enemyArrays) { (function(enemyArrays), ...); }, _enemyArrays);
+}
+
+template<typename Function>
+inline void EnemyManager::ForEachEnemyArray(Function&& function) const {
+	std::apply([&](const auto&... enemyArrays) { (function(enemyArrays), ...); }, _enemyArrays);
+}
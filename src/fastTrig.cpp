@@ -0,0 +1,89 @@
+#include "fastTrig.h"
+
+void FastAtan2Batch(const float* y, const float* x, float* result, size_t count) {
+	size_t i = 0;
+#if defined(VECTOR2_SIMD) && !defined(FAST_TRIG_USE_LIBM)
+	const __m128 signMask = _mm_set1_ps(-0.f);
+	const __m128 zero = _mm_setzero_ps();
+	for (; i + 4 <= count; i += 4) {
+		const __m128 valuesY = _mm_loadu_ps(y + i);
+		const __m128 valuesX = _mm_loadu_ps(x + i);
+		const __m128 absY = _mm_andnot_ps(signMask, valuesY);
+		const __m128 absX = _mm_andnot_ps(signMask, valuesX);
+		const __m128 maxValue = _mm_max_ps(absX, absY);
+
+		// Zero over zero would give NaN, the mask turns those lanes into 0.
+		const __m128 z = _mm_and_ps(_mm_div_ps(_mm_min_ps(absX, absY), maxValue), _mm_cmpgt_ps(maxValue, zero));
+		const __m128 z2 = _mm_mul_ps(z, z);
+		__m128 value = _mm_set1_ps(fastTrigAtanCoefficients[5]);
+		for (int k = 4; k >= 0; k--) {
+			value = _mm_add_ps(_mm_mul_ps(value, z2), _mm_set1_ps(fastTrigAtanCoefficients[k]));
+		}
+		value = _mm_mul_ps(value, z);
+
+		__m128 mask = _mm_cmpgt_ps(absY, absX);
+		value = _mm_or_ps(_mm_and_ps(mask, _mm_sub_ps(_mm_set1_ps(fastTrigHalfPi), value)), _mm_andnot_ps(mask, value));
+		mask = _mm_cmplt_ps(valuesX, zero);
+		value = _mm_or_ps(_mm_and_ps(mask, _mm_sub_ps(_mm_set1_ps(fastTrigPi), value)), _mm_andnot_ps(mask, value));
+		mask = _mm_cmplt_ps(valuesY, zero);
+		value = _mm_xor_ps(value, _mm_and_ps(mask, signMask));
+		_mm_storeu_ps(result + i, value);
+	}
+#endif
+	for (; i < count; i++) {
+		result[i] = FastAtan2(y[i], x[i]);
+	}
+}
+
+void FastSinCosBatch(const float* angles, float* sines, float* cosines, size_t count) {
+	size_t i = 0;
+#if defined(VECTOR2_SIMD) && !defined(FAST_TRIG_USE_LIBM)
+	for (; i + 4 <= count; i += 4) {
+		const __m128 angle = _mm_loadu_ps(angles + i);
+		// cvtps rounds to nearest, which is the quadrant the angle is closest to.
+		const __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(angle, _mm_set1_ps(fastTrigTwoOverPi)));
+		const __m128 quadrantFloat = _mm_cvtepi32_ps(quadrant);
+		const __m128 r = _mm_sub_ps(_mm_sub_ps(angle, _mm_mul_ps(quadrantFloat, _mm_set1_ps(fastTrigHalfPiHigh))),
+			_mm_mul_ps(quadrantFloat, _mm_set1_ps(fastTrigHalfPiLow)));
+		const __m128 r2 = _mm_mul_ps(r, r);
+
+		__m128 sinR = _mm_add_ps(_mm_set1_ps(1.f / 120.f), _mm_mul_ps(r2, _mm_set1_ps(-1.f / 5040.f)));
+		sinR = _mm_add_ps(_mm_set1_ps(-1.f / 6.f), _mm_mul_ps(r2, sinR));
+		sinR = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), sinR));
+
+		__m128 cosR = _mm_add_ps(_mm_set1_ps(-1.f / 720.f), _mm_mul_ps(r2, _mm_set1_ps(1.f / 40320.f)));
+		cosR = _mm_add_ps(_mm_set1_ps(1.f / 24.f), _mm_mul_ps(r2, cosR));
+		cosR = _mm_add_ps(_mm_set1_ps(-0.5f), _mm_mul_ps(r2, cosR));
+		cosR = _mm_add_ps(_mm_set1_ps(1.f), _mm_mul_ps(r2, cosR));
+
+		// Odd quadrants swap sine and cosine, quadrants 2 and 3 negate the sine and
+		// quadrants 1 and 2 negate the cosine.
+		const __m128 swapMask = _mm_castsi128_ps(_mm_cmpeq_epi32(
+			_mm_and_si128(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+		const __m128 sineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+		const __m128 cosineSign = _mm_castsi128_ps(_mm_slli_epi32(
+			_mm_and_si128(_mm_add_epi32(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+
+		const __m128 sine = _mm_or_ps(_mm_and_ps(swapMask, cosR), _mm_andnot_ps(swapMask, sinR));
+		const __m128 cosine = _mm_or_ps(_mm_and_ps(swapMask, sinR), _mm_andnot_ps(swapMask, cosR));
+		_mm_storeu_ps(sines + i, _mm_xor_ps(sine, sineSign));
+		_mm_storeu_ps(cosines + i, _mm_xor_ps(cosine, cosineSign));
+	}
+#endif
+	for (; i < count; i++) {
+		FastSinCos(angles[i], sines[i], cosines[i]);
+	}
+}
+
+const UnitCircleTable& GetUnitCircleTable() {
+	static UnitCircleTable unitCircleTable = [] {
+		UnitCircleTable table;
+		for (unsigned int k = 0; k <= UnitCircleTable::resolution; k++) {
+			const double angle = (2.0 * 3.14159265358979323846 * (k % UnitCircleTable::resolution)) /
+				UnitCircleTable::resolution;
+			table.points[k] = Vector2<float>((float)std::cos(angle), (float)std::sin(angle));
+		}
+		return table;
+	}();
+	return unitCircleTable;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "vector2.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Polynomial approximations of the trig functions used for orientation math.
+//
+//   FastAtan2   max error 2.0e-6 rad (about 0.0001 degrees) over all inputs
+//   FastSinCos  max error 4.0e-7 for angles within [-pi, pi] and 4.0e-6 within
+//               [-100, 100], the float range reduction loses bits as |angle| grows
+//
+// Define FAST_TRIG_USE_LIBM to route every function to the C library instead,
+// which is useful to check whether a bug comes from the approximations.
+
+const float fastTrigPi = 3.14159265358979f;
+const float fastTrigHalfPi = 1.57079632679490f;
+const float fastTrigTwoOverPi = 0.636619772367581f;
+
+// pi/2 split in two parts so the range reduction keeps precision.
+const float fastTrigHalfPiHigh = 1.5707963705062866f;
+const float fastTrigHalfPiLow = -4.371139000186243e-8f;
+
+// Minimax fit of atan(z) / z over z in [0, 1], in powers of z^2.
+const float fastTrigAtanCoefficients[6] = {
+	0.99997726f, -0.33262347f, 0.19354346f, -0.11643287f, 0.05265332f, -0.01172120f };
+
+inline float FastAtan2(float y, float x) {
+#ifdef FAST_TRIG_USE_LIBM
+	return std::atan2(y, x);
+#else
+	const float absX = std::fabs(x);
+	const float absY = std::fabs(y);
+	const float maxValue = absX > absY ? absX : absY;
+	if (maxValue == 0.f) {
+		return 0.f;
+	}
+	const float z = (absX < absY ? absX : absY) / maxValue;
+	const float z2 = z * z;
+	float result = fastTrigAtanCoefficients[5];
+	result = result * z2 + fastTrigAtanCoefficients[4];
+	result = result * z2 + fastTrigAtanCoefficients[3];
+	result = result * z2 + fastTrigAtanCoefficients[2];
+	result = result * z2 + fastTrigAtanCoefficients[1];
+	result = result * z2 + fastTrigAtanCoefficients[0];
+	result *= z;
+
+	if (absY > absX) {
+		result = fastTrigHalfPi - result;
+	}
+	if (x < 0.f) {
+		result = fastTrigPi - result;
+	}
+	return y < 0.f ? -result : result;
+#endif
+}
+
+inline void FastSinCos(float angle, float& sine, float& cosine) {
+#ifdef FAST_TRIG_USE_LIBM
+	sine = std::sin(angle);
+	cosine = std::cos(angle);
+#else
+	// Reduce to r in [-pi/4, pi/4] and the quadrant the angle was in.
+	const float scaled = angle * fastTrigTwoOverPi;
+	const float quadrant = (float)(int)(scaled >= 0.f ? scaled + 0.5f : scaled - 0.5f);
+	const float r = (angle - quadrant * fastTrigHalfPiHigh) - quadrant * fastTrigHalfPiLow;
+	const float r2 = r * r;
+
+	const float sinR = r + r * r2 * (-1.f / 6.f + r2 * (1.f / 120.f + r2 * (-1.f / 5040.f)));
+	const float cosR = 1.f + r2 * (-0.5f + r2 * (1.f / 24.f + r2 * (-1.f / 720.f + r2 * (1.f / 40320.f))));
+
+	// Odd quadrants swap sine and cosine, quadrants 2 and 3 negate the sine and
+	// quadrants 1 and 2 negate the cosine.
+	// Done on the float bits since the quadrant is random per call and branches mispredict.
+	const uint32_t quadrantIndex = (uint32_t)(int)quadrant;
+	const uint32_t swapMask = 0u - (quadrantIndex & 1u);
+	uint32_t sinBits;
+	uint32_t cosBits;
+	std::memcpy(&sinBits, &sinR, sizeof(float));
+	std::memcpy(&cosBits, &cosR, sizeof(float));
+	const uint32_t sineBits = ((cosBits & swapMask) | (sinBits & ~swapMask)) ^ ((quadrantIndex & 2u) << 30);
+	const uint32_t cosineBits = ((sinBits & swapMask) | (cosBits & ~swapMask)) ^ (((quadrantIndex + 1u) & 2u) << 30);
+	std::memcpy(&sine, &sineBits, sizeof(float));
+	std::memcpy(&cosine, &cosineBits, sizeof(float));
+#endif
+}
+
+// Batch versions, four values per SSE instruction with a scalar tail. Same error as above.
+void FastAtan2Batch(const float* y, const float* x, float* result, size_t count);
+void FastSinCosBatch(const float* angles, float* sines, float* cosines, size_t count);
+
+// Points on the unit circle, point k is at angle k * 2pi / resolution. The last point
+// repeats the first one so segments can be drawn as points[k] to points[k + 1].
+struct UnitCircleTable {
+	static const unsigned int resolution = 24;
+
+	std::array<Vector2<float>, resolution + 1> points;
+};
+
+const UnitCircleTable& GetUnitCircleTable();
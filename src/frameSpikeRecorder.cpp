@@ -0,0 +1,107 @@
+#include "frameSpikeRecorder.h"
+
+#include "enemyBase.h"
+#include "gameEngine.h"
+#include "imGuiManager.h"
+#include "projectile.h"
+
+#include <algorithm>
+#include <fstream>
+
+FrameSpikeRecorder::FrameSpikeRecorder(float frameBudget) {
+	_frameBudget = frameBudget;
+}
+
+void FrameSpikeRecorder::RecordFrame() {
+	_frameIndex = (_frameIndex + 1) % frameHistorySize;
+	FrameRecord& frameRecord = _frameRecords[_frameIndex];
+
+	frameRecord.frameNumber = frameNumber;
+	frameRecord.frameTime = performanceProfiler->GetFrameTime();
+	frameRecord.allocations = performanceProfiler->GetAllocationsThisFrame();
+	for (unsigned int i = 0; i < (unsigned int)ProfilerPhase::Count; i++) {
+		frameRecord.phaseTimes[i] = performanceProfiler->GetPhaseTime((ProfilerPhase)i);
+	}
+	for (unsigned int i = 0; i < (unsigned int)EnemyType::Count && i < PerformanceProfiler::typeCountLimit; i++) {
+		frameRecord.activeEnemies[i] = performanceProfiler->GetActiveEnemyCount(i);
+		frameRecord.pooledEnemies[i] = performanceProfiler->GetPooledEnemyCount(i);
+	}
+	for (unsigned int i = 0; i < (unsigned int)ProjectileType::Count && i < PerformanceProfiler::typeCountLimit; i++) {
+		frameRecord.activeProjectiles[i] = performanceProfiler->GetActiveProjectileCount(i);
+		frameRecord.pooledProjectiles[i] = performanceProfiler->GetPooledProjectileCount(i);
+	}
+	frameRecord.enemyBroadphaseNodes = performanceProfiler->GetEnemyBroadphaseStatistics().nodeCount;
+	frameRecord.projectileBroadphaseNodes = performanceProfiler->GetProjectileBroadphaseStatistics().nodeCount;
+	frameRecord.timerCount = performanceProfiler->GetTimerCount();
+	frameRecord.spawnQueueDepth = performanceProfiler->GetSpawnQueueDepth();
+	frameRecord.spawned = performanceProfiler->GetSpawnedLastFrame();
+	frameRecord.spawnCost = performanceProfiler->GetSpawnCostLastFrame();
+
+	_framesRecorded = std::min(_framesRecorded + 1, frameHistorySize);
+	_framesSinceTrace++;
+
+	// Wait for a full window of new frames so a long hitch only produces one trace.
+	if (frameRecord.frameTime > _frameBudget && _framesSinceTrace >= frameHistorySize) {
+		WriteTrace();
+	}
+}
+
+void FrameSpikeRecorder::UpdateImgui() {
+	imGuiHandler->SliderFloat("Frame spikes", "Budget (ms)", _frameBudget, 1.f, 100.f);
+	imGuiHandler->ShowIntValue("Frame spikes", "Captured", _spikesCaptured);
+	if (!_lastTracePath.empty()) {
+		imGuiHandler->ShowText("Frame spikes", _lastTracePath.c_str());
+	}
+}
+
+void FrameSpikeRecorder::SetFrameBudget(float frameBudget) {
+	_frameBudget = frameBudget;
+}
+
+const unsigned int FrameSpikeRecorder::GetSpikesCaptured() const {
+	return _spikesCaptured;
+}
+
+void FrameSpikeRecorder::WriteTrace() {
+	std::string tracePath = "frameSpike_" + std::to_string(frameNumber) + ".csv";
+	std::ofstream traceFile(tracePath);
+	if (!traceFile.is_open()) {
+		return;
+	}
+	traceFile << "# budget_ms=" << _frameBudget << "\n";
+	traceFile << "frame,frame_ms,allocations,timers,enemy_broadphase_nodes,projectile_broadphase_nodes,"
+		"spawn_queue,spawned,spawn_ms";
+	for (unsigned int i = 0; i < (unsigned int)ProfilerPhase::Count; i++) {
+		traceFile << "," << GetProfilerPhaseName((ProfilerPhase)i) << "_ms";
+	}
+	for (unsigned int i = 0; i < (unsigned int)EnemyType::Count; i++) {
+		traceFile << ",enemy" << i << "_active,enemy" << i << "_pooled";
+	}
+	for (unsigned int i = 0; i < (unsigned int)ProjectileType::Count; i++) {
+		traceFile << ",projectile" << i << "_active,projectile" << i << "_pooled";
+	}
+	traceFile << "\n";
+
+	for (unsigned int k = 0; k < _framesRecorded; k++) {
+		const FrameRecord& frameRecord =
+			_frameRecords[(_frameIndex + frameHistorySize - _framesRecorded + 1 + k) % frameHistorySize];
+		traceFile << frameRecord.frameNumber << "," << frameRecord.frameTime << ","
+			<< frameRecord.allocations << "," << frameRecord.timerCount << ","
+			<< frameRecord.enemyBroadphaseNodes << "," << frameRecord.projectileBroadphaseNodes << ","
+			<< frameRecord.spawnQueueDepth << "," << frameRecord.spawned << "," << frameRecord.spawnCost;
+		for (unsigned int i = 0; i < (unsigned int)ProfilerPhase::Count; i++) {
+			traceFile << "," << frameRecord.phaseTimes[i];
+		}
+		for (unsigned int i = 0; i < (unsigned int)EnemyType::Count; i++) {
+			traceFile << "," << frameRecord.activeEnemies[i] << "," << frameRecord.pooledEnemies[i];
+		}
+		for (unsigned int i = 0; i < (unsigned int)ProjectileType::Count; i++) {
+			traceFile << "," << frameRecord.activeProjectiles[i] << "," << frameRecord.pooledProjectiles[i];
+		}
+		traceFile << "\n";
+	}
+
+	_lastTracePath = tracePath;
+	_framesSinceTrace = 0;
+	_spikesCaptured++;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "performanceProfiler.h"
+
+#include <array>
+#include <string>
+
+struct FrameRecord {
+	std::array<float, (unsigned int)ProfilerPhase::Count> phaseTimes = {};
+	std::array<unsigned int, PerformanceProfiler::typeCountLimit> activeEnemies = {};
+	std::array<unsigned int, PerformanceProfiler::typeCountLimit> pooledEnemies = {};
+	std::array<unsigned int, PerformanceProfiler::typeCountLimit> activeProjectiles = {};
+	std::array<unsigned int, PerformanceProfiler::typeCountLimit> pooledProjectiles = {};
+
+	float frameTime = 0.f;
+	float spawnCost = 0.f;
+
+	int frameNumber = 0;
+
+	unsigned int allocations = 0;
+	unsigned int enemyBroadphaseNodes = 0;
+	unsigned int projectileBroadphaseNodes = 0;
+	unsigned int spawnQueueDepth = 0;
+	unsigned int spawned = 0;
+	unsigned int timerCount = 0;
+};
+
+// Keeps the last frames in a ring buffer and writes them to a trace file
+// whenever a frame goes over the frame budget.
+class FrameSpikeRecorder {
+public:
+	FrameSpikeRecorder(float frameBudget);
+	~FrameSpikeRecorder() {}
+
+	void RecordFrame();
+	void UpdateImgui();
+
+	void SetFrameBudget(float frameBudget);
+
+	const unsigned int GetSpikesCaptured() const;
+
+	static const unsigned int frameHistorySize = 120;
+
+private:
+	void WriteTrace();
+
+	std::array<FrameRecord, frameHistorySize> _frameRecords;
+
+	std::string _lastTracePath;
+
+	float _frameBudget = 0.f;
+
+	unsigned int _frameIndex = 0;
+	unsigned int _framesRecorded = 0;
+	unsigned int _framesSinceTrace = frameHistorySize;
+	unsigned int _spikesCaptured = 0;
+};
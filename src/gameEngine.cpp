@@ -2,12 +2,20 @@
 
 #include "debugDrawer.h"
 #include "enemyManager.h"
+#include "frameSpikeRecorder.h"
 #include "imGuiManager.h"
+#include "inputQueue.h"
+#include "performanceProfiler.h"
 #include "playerCharacter.h"
 #include "projectileManager.h"
+#include "rotatedSpriteCache.h"
+#include "simulationThread.h"
+#include "spriteRasterizer.h"
 #include "stateStack.h"
 #include "steeringBehaviour.h"
 #include "timerManager.h"
+#include "weaponSystem.h"
+#include "workerPool.h"
 
 #include <vector>
 
@@ -16,12 +24,20 @@ SDL_Renderer* renderer;
 
 std::shared_ptr<EnemyManager> enemyManager;
 std::shared_ptr<DebugDrawer> debugDrawer;
+std::shared_ptr<FrameSpikeRecorder> frameSpikeRecorder;
 std::shared_ptr<GameStateHandler> gameStateHandler;
 std::shared_ptr<ImGuiHandler> imGuiHandler;
+std::shared_ptr<InputQueue> inputQueue;
+std::shared_ptr<PerformanceProfiler> performanceProfiler;
 std::shared_ptr<PlayerCharacter> playerCharacter;
 std::shared_ptr<ProjectileManager> projectileManager;
+std::shared_ptr<RotatedSpriteCache> rotatedSpriteCache;
+std::shared_ptr<SimulationThread> simulationThread;
 std::shared_ptr<SteeringBehaviour> separationBehaviour;
+std::shared_ptr<SpriteRasterizer> spriteRasterizer;
 std::shared_ptr<TimerManager> timerManager;
+std::shared_ptr<WeaponSystem> weaponSystem;
+std::shared_ptr<WorkerPool> workerPool;
 std::unordered_map<ButtonType, std::shared_ptr<Button>> _buttons;
 
 bool runningGame = false;
@@ -65,8 +81,8 @@ void ClearText(SDL_Surface* textSurface, SDL_Texture* textTexture) {
 	SDL_DestroyTexture(textTexture);
 }
 
-float deltaTime = 0.f;
-int frameNumber = 0;
+thread_local float deltaTime = 0.f;
+thread_local int frameNumber = 0;
 
 std::random_device randomDevice;
 std::mt19937 randomEngine(randomDevice());
\ No newline at end of file
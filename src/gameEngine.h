@@ -14,12 +14,20 @@
 class Button;
 class DebugDrawer;
 class EnemyManager;
+class FrameSpikeRecorder;
 class GameStateHandler;
 class ImGuiHandler;
+class InputQueue;
+class PerformanceProfiler;
 class PlayerCharacter;
 class ProjectileManager;
+class RotatedSpriteCache;
+class SimulationThread;
+class SpriteRasterizer;
 class SteeringBehaviour;
 class TimerManager;
+class WeaponSystem;
+class WorkerPool;
 
 enum class ButtonType;
 
@@ -28,12 +36,20 @@ extern SDL_Renderer* renderer;
 
 extern std::shared_ptr<EnemyManager> enemyManager;
 extern std::shared_ptr<DebugDrawer> debugDrawer;
+extern std::shared_ptr<FrameSpikeRecorder> frameSpikeRecorder;
 extern std::shared_ptr<GameStateHandler> gameStateHandler;
 extern std::shared_ptr<ImGuiHandler> imGuiHandler;
+extern std::shared_ptr<InputQueue> inputQueue;
+extern std::shared_ptr<PerformanceProfiler> performanceProfiler;
 extern std::shared_ptr<PlayerCharacter> playerCharacter;
 extern std::shared_ptr<ProjectileManager> projectileManager;
+extern std::shared_ptr<RotatedSpriteCache> rotatedSpriteCache;
+extern std::shared_ptr<SimulationThread> simulationThread;
 extern std::shared_ptr<SteeringBehaviour> separationBehaviour;
+extern std::shared_ptr<SpriteRasterizer> spriteRasterizer;
 extern std::shared_ptr<TimerManager> timerManager;
+extern std::shared_ptr<WeaponSystem> weaponSystem;
+extern std::shared_ptr<WorkerPool> workerPool;
 extern std::unordered_map<ButtonType, std::shared_ptr<Button>> _buttons;
 extern bool runningGame;
 
@@ -64,8 +80,9 @@ void DrawText(SDL_Texture* textTexture, SDL_Rect* textSrcrect, SDL_Rect textDst)
 void ClearText(SDL_Surface* textSurface, SDL_Texture* textTexture);
 
 
-extern float deltaTime;
-extern int frameNumber;
+// Per thread so the simulation thread can step with its own fixed time step and tick count.
+extern thread_local float deltaTime;
+extern thread_local int frameNumber;
 
 extern std::random_device randomDevice;
 extern std::mt19937 randomEngine;
\ No newline at end of file
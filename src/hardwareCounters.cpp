@@ -0,0 +1,132 @@
+#include "hardwareCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+const char* GetHardwareCounterName(HardwareCounter counter) {
+	switch (counter) {
+	case HardwareCounter::Cycles:
+		return "Cycles";
+	case HardwareCounter::Instructions:
+		return "Instructions";
+	case HardwareCounter::L1DataMisses:
+		return "L1D misses";
+	case HardwareCounter::LastLevelCacheMisses:
+		return "LLC misses";
+	case HardwareCounter::BranchMisses:
+		return "Branch misses";
+	default:
+		return "Unknown";
+	}
+}
+
+void HardwareCounterSample::Add(const HardwareCounterSample& start, const HardwareCounterSample& end) {
+	for (unsigned int i = 0; i < values.size(); i++) {
+		values[i] += end.values[i] - start.values[i];
+	}
+}
+
+void HardwareCounterSample::Reset() {
+	values.fill(0);
+}
+
+const uint64_t HardwareCounterSample::GetValue(HardwareCounter counter) const {
+	return values[(unsigned int)counter];
+}
+
+const float HardwareCounterSample::GetInstructionsPerCycle() const {
+	if (GetValue(HardwareCounter::Cycles) == 0) {
+		return 0.f;
+	}
+	return (float)GetValue(HardwareCounter::Instructions) / (float)GetValue(HardwareCounter::Cycles);
+}
+
+HardwareCounters::HardwareCounters() {
+	_fileDescriptors.fill(-1);
+}
+
+HardwareCounters::~HardwareCounters() {
+	Close();
+}
+
+#ifdef __linux__
+static int OpenPerfEvent(uint32_t type, uint64_t config) {
+	perf_event_attr attributes;
+	std::memset(&attributes, 0, sizeof(attributes));
+	attributes.size = sizeof(attributes);
+	attributes.type = type;
+	attributes.config = config;
+	attributes.exclude_kernel = 1;
+	attributes.exclude_hv = 1;
+	return (int)syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+}
+
+bool HardwareCounters::Open() {
+	Close();
+	_fileDescriptors[(unsigned int)HardwareCounter::Cycles] =
+		OpenPerfEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+	_fileDescriptors[(unsigned int)HardwareCounter::Instructions] =
+		OpenPerfEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+	_fileDescriptors[(unsigned int)HardwareCounter::L1DataMisses] =
+		OpenPerfEvent(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+			(PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+	_fileDescriptors[(unsigned int)HardwareCounter::LastLevelCacheMisses] =
+		OpenPerfEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+	_fileDescriptors[(unsigned int)HardwareCounter::BranchMisses] =
+		OpenPerfEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+
+	for (unsigned int i = 0; i < _fileDescriptors.size(); i++) {
+		if (_fileDescriptors[i] >= 0) {
+			_open = true;
+		}
+	}
+	return _open;
+}
+
+void HardwareCounters::Close() {
+	for (unsigned int i = 0; i < _fileDescriptors.size(); i++) {
+		if (_fileDescriptors[i] >= 0) {
+			close(_fileDescriptors[i]);
+			_fileDescriptors[i] = -1;
+		}
+	}
+	_open = false;
+}
+
+HardwareCounterSample HardwareCounters::Read() const {
+	HardwareCounterSample sample;
+	for (unsigned int i = 0; i < _fileDescriptors.size(); i++) {
+		uint64_t value = 0;
+		if (_fileDescriptors[i] >= 0 && read(_fileDescriptors[i], &value, sizeof(value)) == sizeof(value)) {
+			sample.values[i] = value;
+		}
+	}
+	return sample;
+}
+#else
+bool HardwareCounters::Open() {
+	return false;
+}
+
+void HardwareCounters::Close() {
+	_open = false;
+}
+
+HardwareCounterSample HardwareCounters::Read() const {
+	return HardwareCounterSample();
+}
+#endif
+
+const bool HardwareCounters::IsOpen() const {
+	return _open;
+}
+
+const bool HardwareCounters::IsCounterAvailable(HardwareCounter counter) const {
+	return _fileDescriptors[(unsigned int)counter] >= 0;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+enum class HardwareCounter {
+	Cycles,
+	Instructions,
+	L1DataMisses,
+	LastLevelCacheMisses,
+	BranchMisses,
+	Count
+};
+
+const char* GetHardwareCounterName(HardwareCounter counter);
+
+struct HardwareCounterSample {
+	std::array<uint64_t, (unsigned int)HardwareCounter::Count> values = {};
+
+	void Add(const HardwareCounterSample& start, const HardwareCounterSample& end);
+	void Reset();
+
+	const uint64_t GetValue(HardwareCounter counter) const;
+	const float GetInstructionsPerCycle() const;
+};
+
+// Reads CPU performance counters for the calling thread through perf_event_open.
+// Only implemented on Linux; Open() returns false on every other platform, or when
+// the kernel refuses access (see /proc/sys/kernel/perf_event_paranoid).
+class HardwareCounters {
+public:
+	HardwareCounters();
+	~HardwareCounters();
+
+	bool Open();
+	void Close();
+
+	const bool IsOpen() const;
+	const bool IsCounterAvailable(HardwareCounter counter) const;
+
+	HardwareCounterSample Read() const;
+
+private:
+	std::array<int, (unsigned int)HardwareCounter::Count> _fileDescriptors;
+
+	bool _open = false;
+};
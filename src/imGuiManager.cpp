@@ -7,7 +7,20 @@ void ImGuiHandler::Init() {
 	ImGuiIO& io = ImGui::GetIO(); (void)io;
 
 	ImGui_ImplSDL2_InitForSDLRenderer(window, renderer);
-	ImGuiSDL::Initialize(renderer, windowWidth, windowHeight);
+	InitRenderBackend();
+}
+
+void ImGuiHandler::NewFrame() {
+	if (_requestedRenderBackend != _renderBackend) {
+		ShutDownRenderBackend();
+		_renderBackend = _requestedRenderBackend;
+		InitRenderBackend();
+	}
+	if (_renderBackend == ImGuiRenderBackend::SDLRenderer) {
+		ImGui_ImplSDLRenderer_NewFrame();
+	}
+	ImGui_ImplSDL2_NewFrame();
+	ImGui::NewFrame();
 }
 
 void ImGuiHandler::ShowFloatValue(const char* name, const char* label, float a) {
@@ -26,6 +39,20 @@ void ImGuiHandler::ShowFloat2Value(const char* name, const char* label, float a,
 	ImGui::End();
 }
 
+void ImGuiHandler::ShowIntValue(const char* name, const char* label, int a) {
+	ImGui::Begin(name);
+	ImGui::Text(label);
+	ImGui::SameLine();
+	ImGui::Text(": %d", a);
+	ImGui::End();
+}
+
+void ImGuiHandler::ShowText(const char* name, const char* text) {
+	ImGui::Begin(name);
+	ImGui::TextUnformatted(text);
+	ImGui::End();
+}
+
 void ImGuiHandler::InputFloat(const char* name, const char* label, float& a) {
 	ImGui::Begin(name);
 	ImGui::InputFloat(label, &a);
@@ -38,6 +65,12 @@ void ImGuiHandler::InputFloat2(const char* name, const char* label, float& a, fl
 	ImGui::End();
 }
 
+void ImGuiHandler::Checkbox(const char* name, const char* label, bool& value) {
+	ImGui::Begin(name);
+	ImGui::Checkbox(label, &value);
+	ImGui::End();
+}
+
 void ImGuiHandler::SliderFloat2(const char* name, const char* label, float& a, float& b, float min, float max) {
 	ImGui::Begin(name);
 	ImGui::SliderFloat2(label, (&b, &a), min, max);
@@ -50,13 +83,79 @@ void ImGuiHandler::SliderFloat(const char* name, const char* label, float& a,flo
 	ImGui::End();
 }
 
+void ImGuiHandler::PlotLines(const char* name, const char* label, const float* values, int count, int offset,
+	const char* overlay, float min, float max) {
+	ImGui::Begin(name);
+	ImGui::PlotLines(label, values, count, offset, overlay, min, max, ImVec2(0, 80));
+	ImGui::End();
+}
+
+void ImGuiHandler::PlotHistogram(const char* name, const char* label, const float* values, int count,
+	const char* overlay, float min, float max) {
+	ImGui::Begin(name);
+	ImGui::PlotHistogram(label, values, count, 0, overlay, min, max, ImVec2(0, 60));
+	ImGui::End();
+}
+
 void ImGuiHandler::Render() {
+	const Uint64 renderStart = SDL_GetPerformanceCounter();
 	ImGui::Render();
-	ImGuiSDL::Render(ImGui::GetDrawData());
+	if (_renderBackend == ImGuiRenderBackend::SDLRenderer) {
+		ImGui_ImplSDLRenderer_RenderDrawData(ImGui::GetDrawData());
+	} else {
+		ImGuiSDL::Render(ImGui::GetDrawData());
+	}
+	_renderTime = (float)(SDL_GetPerformanceCounter() - renderStart) * 1000.f / (float)SDL_GetPerformanceFrequency();
 }
 
 void ImGuiHandler::ShutDown() {
 	ImGui_ImplSDL2_Shutdown();
-	ImGuiSDL::Deinitialize();
+	ShutDownRenderBackend();
 	ImGui::DestroyContext();
 }
+
+void ImGuiHandler::SetRenderBackend(ImGuiRenderBackend renderBackend) {
+	_requestedRenderBackend = renderBackend;
+}
+
+const ImGuiRenderBackend ImGuiHandler::GetRenderBackend() const {
+	return _renderBackend;
+}
+
+const float ImGuiHandler::GetRenderTime() const {
+	return _renderTime;
+}
+
+// Shows last frame's draw data, the current one isn't built until Render.
+void ImGuiHandler::UpdateImgui() {
+	bool legacyRenderer = _requestedRenderBackend == ImGuiRenderBackend::ImGuiSDL;
+	Checkbox("ImGui overlay", "Legacy imgui_sdl renderer", legacyRenderer);
+	SetRenderBackend(legacyRenderer ? ImGuiRenderBackend::ImGuiSDL : ImGuiRenderBackend::SDLRenderer);
+	ShowFloatValue("ImGui overlay", "Render (ms)", _renderTime);
+	const ImDrawData* drawData = ImGui::GetDrawData();
+	if (drawData) {
+		ShowIntValue("ImGui overlay", "Draw lists", drawData->CmdListsCount);
+		ShowIntValue("ImGui overlay", "Vertices", drawData->TotalVtxCount);
+	}
+}
+
+// imgui_sdl turns anti-aliasing off and leaves its font texture in the atlas when it
+// shuts down, so both are reset for the geometry renderer.
+void ImGuiHandler::InitRenderBackend() {
+	if (_renderBackend == ImGuiRenderBackend::SDLRenderer) {
+		ImGui::GetStyle().AntiAliasedFill = true;
+		ImGui::GetStyle().AntiAliasedLines = true;
+		ImGui_ImplSDLRenderer_Init(renderer);
+	} else {
+		ImGuiSDL::Initialize(renderer, windowWidth, windowHeight);
+	}
+}
+
+void ImGuiHandler::ShutDownRenderBackend() {
+	if (_renderBackend == ImGuiRenderBackend::SDLRenderer) {
+		ImGui_ImplSDLRenderer_Shutdown();
+	} else {
+		ImGuiSDL::Deinitialize();
+		ImGui::GetIO().Fonts->SetTexID(nullptr);
+	}
+}
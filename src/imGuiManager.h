@@ -2,6 +2,16 @@
 #include "ImGui/imgui.h"
 #include "ImGui/imgui_sdl.h"
 #include "ImGui/imgui_impl_sdl.h"
+#include "ImGui/imgui_impl_sdlrenderer.h"
+
+// SDLRenderer submits every draw list with SDL_RenderGeometry and a font atlas texture.
+// ImGuiSDL is the old imgui_sdl renderer, which splits the triangles into rectangles
+// and rasterises the rest itself, kept to compare the overlay cost against.
+enum class ImGuiRenderBackend {
+	SDLRenderer,
+	ImGuiSDL,
+	Count
+};
 
 class ImGuiHandler {
 public:
@@ -9,17 +19,43 @@ public:
 	~ImGuiHandler() {}
 
 	void Init();
+	// Starts the ImGui frame, switching the render backend first if one was requested.
+	void NewFrame();
 	void ShowFloatValue(const char* name, const char* label, float a);
 	void ShowFloat2Value(const char* name, const char* label, float a, float b);
+	void ShowIntValue(const char* name, const char* label, int a);
+	void ShowText(const char* name, const char* text);
 	
 	void InputFloat(const char* name, const char* label, float& a);
 	void InputFloat2(const char* name, const char* label, float& a, float& b);
 	
+	void Checkbox(const char* name, const char* label, bool& value);
+
 	void SliderFloat(const char* name, const char* label, float& a, float min, float max);
 	void SliderFloat2(const char* name, const char* label, float& a, float& b, float min, float max);
 
+	void PlotLines(const char* name, const char* label, const float* values, int count, int offset,
+		const char* overlay, float min, float max);
+	void PlotHistogram(const char* name, const char* label, const float* values, int count,
+		const char* overlay, float min, float max);
+
 	void Render();
 	void ShutDown();
 
+	// Takes effect at the next NewFrame, draw data already built refers to the current font texture.
+	void SetRenderBackend(ImGuiRenderBackend renderBackend);
+	const ImGuiRenderBackend GetRenderBackend() const;
+	// Time of the last Render, building the draw data and submitting it.
+	const float GetRenderTime() const;
+
+	void UpdateImgui();
+
+private:
+	void InitRenderBackend();
+	void ShutDownRenderBackend();
+
+	ImGuiRenderBackend _renderBackend = ImGuiRenderBackend::SDLRenderer;
+	ImGuiRenderBackend _requestedRenderBackend = ImGuiRenderBackend::SDLRenderer;
+	float _renderTime = 0.f;
 };
 
@@ -0,0 +1,97 @@
+#include "inputQueue.h"
+
+#include "gameEngine.h"
+#include "imGuiManager.h"
+
+bool InputQueue::Push(const InputEvent& inputEvent) {
+	const unsigned int head = _head.load(std::memory_order_relaxed);
+	if (head - _tail.load(std::memory_order_acquire) == capacity) {
+		_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	_events[head % capacity] = inputEvent;
+	_head.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+void InputQueue::DispatchEvents() {
+	const Uint64 now = SDL_GetPerformanceCounter();
+	const float frequency = (float)SDL_GetPerformanceFrequency();
+	float averageLatency = _averageLatency.load(std::memory_order_relaxed);
+
+	unsigned int tail = _tail.load(std::memory_order_relaxed);
+	const unsigned int head = _head.load(std::memory_order_acquire);
+	while (tail != head) {
+		const InputEvent& inputEvent = _events[tail % capacity];
+		// A key pressed and released within one tick would otherwise never be seen as
+		// pressed, the second change waits for the next tick instead.
+		if (ChangedThisTick(inputEvent)) {
+			break;
+		}
+		switch (inputEvent.type) {
+		case InputEventType::KeyDown:
+		case InputEventType::KeyUp:
+			keys[inputEvent.code].state = inputEvent.type == InputEventType::KeyDown;
+			keys[inputEvent.code].changeFrame = frameNumber;
+			break;
+
+		case InputEventType::MouseButtonDown:
+		case InputEventType::MouseButtonUp:
+			mouseButtons[inputEvent.code].state = inputEvent.type == InputEventType::MouseButtonDown;
+			mouseButtons[inputEvent.code].changeFrame = frameNumber;
+			break;
+
+		default:
+			break;
+		}
+
+		const float latency = (float)(now - inputEvent.timestamp) * 1000.f / frequency;
+		averageLatency += (latency - averageLatency) * 0.1f;
+		if (latency > _windowMaxLatency) {
+			_windowMaxLatency = latency;
+		}
+		tail++;
+	}
+	_tail.store(tail, std::memory_order_release);
+	_averageLatency.store(averageLatency, std::memory_order_relaxed);
+
+	// The max is kept over one second windows so a single hitch doesn't stick forever.
+	if (now - _maxLatencyWindowStart >= SDL_GetPerformanceFrequency()) {
+		_maxLatency.store(_windowMaxLatency, std::memory_order_relaxed);
+		_windowMaxLatency = 0.f;
+		_maxLatencyWindowStart = now;
+	}
+}
+
+void InputQueue::UpdateImgui() {
+	imGuiHandler->ShowFloatValue("Input", "Input to simulation avg (ms)", GetAverageLatency());
+	imGuiHandler->ShowFloatValue("Input", "Input to simulation max (ms)", GetMaxLatency());
+	imGuiHandler->ShowIntValue("Input", "Dropped events", GetDroppedEvents());
+}
+
+const float InputQueue::GetAverageLatency() const {
+	return _averageLatency.load(std::memory_order_relaxed);
+}
+
+const float InputQueue::GetMaxLatency() const {
+	return _maxLatency.load(std::memory_order_relaxed);
+}
+
+const unsigned int InputQueue::GetDroppedEvents() const {
+	return _droppedEvents.load(std::memory_order_relaxed);
+}
+
+bool InputQueue::ChangedThisTick(const InputEvent& inputEvent) const {
+	switch (inputEvent.type) {
+	case InputEventType::KeyDown:
+	case InputEventType::KeyUp:
+		return keys[inputEvent.code].changeFrame == frameNumber;
+
+	case InputEventType::MouseButtonDown:
+	case InputEventType::MouseButtonUp:
+		return mouseButtons[inputEvent.code].changeFrame == frameNumber;
+
+	default:
+		return false;
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <SDL2/SDL.h>
+
+#include <array>
+#include <atomic>
+
+enum class InputEventType {
+	KeyDown,
+	KeyUp,
+	MouseButtonDown,
+	MouseButtonUp,
+	Count
+};
+
+struct InputEvent {
+	Uint64 timestamp = 0;
+	InputEventType type = InputEventType::Count;
+	int code = 0;
+};
+
+// Single producer, single consumer ring buffer of input events. The main thread
+// pushes events as it polls them and the simulation consumes them once per fixed
+// tick, applying them to keys[] and mouseButtons[] with that tick's number.
+class InputQueue {
+public:
+	InputQueue() {}
+	~InputQueue() {}
+
+	bool Push(const InputEvent& inputEvent);
+	void DispatchEvents();
+	void UpdateImgui();
+
+	const float GetAverageLatency() const;
+	const float GetMaxLatency() const;
+	const unsigned int GetDroppedEvents() const;
+
+	static const unsigned int capacity = 256;
+
+private:
+	bool ChangedThisTick(const InputEvent& inputEvent) const;
+
+	std::array<InputEvent, capacity> _events;
+
+	// Written by one side each, padded apart so the two threads don't share a cache line.
+	alignas(64) std::atomic<unsigned int> _head = 0;
+	alignas(64) std::atomic<unsigned int> _tail = 0;
+
+	std::atomic<float> _averageLatency = 0.f;
+	std::atomic<float> _maxLatency = 0.f;
+	std::atomic<unsigned int> _droppedEvents = 0;
+
+	Uint64 _maxLatencyWindowStart = 0;
+	float _windowMaxLatency = 0.f;
+};
@@ -0,0 +1,145 @@
+#pragma once
+#include "broadphase.h"
+#include "collisionLayers.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// One broadphase per collision layer. Build sorts the objects into their layers and
+// builds each layer on its own, Query only walks the layers in its mask.
+//
+// Layers without a broadphase set are skipped, objects on them are dropped by Build.
+// Like Broadphase, Query can run on several threads at once between Build and Clear.
+template<typename T>
+class LayeredBroadphase {
+public:
+	LayeredBroadphase() {}
+	~LayeredBroadphase() {}
+
+	void SetLayerBroadphase(CollisionLayer collisionLayer, std::shared_ptr<Broadphase<T>> broadphase);
+	Broadphase<T>* GetLayerBroadphase(CollisionLayer collisionLayer);
+
+	void Build(const std::vector<T>& objects, const std::vector<Circle>& circleColliders,
+		const std::vector<CollisionLayer>& collisionLayers);
+
+	std::vector<T> Query(Circle range, CollisionMask collisionMask);
+
+	// Summed over the layers. The result counts compare what the masked queries returned
+	// against what the same queries on one shared broadphase would have returned.
+	BroadphaseStatistics GetStatistics();
+
+	void Clear();
+
+	void Render();
+
+private:
+	static const unsigned int layerCount = (unsigned int)CollisionLayer::Count;
+
+	std::array<std::shared_ptr<Broadphase<T>>, layerCount> _layerBroadphases;
+	std::array<std::vector<T>, layerCount> _layerObjects;
+	std::array<std::vector<Circle>, layerCount> _layerColliders;
+
+	// Counted apart from the layers' query counts, a query over two layers queries both.
+	std::atomic<unsigned int> _queryCount = 0;
+	std::atomic<unsigned int> _maskedResultCount = 0;
+	std::atomic<unsigned int> _unmaskedResultCount = 0;
+};
+
+template<typename T>
+inline void LayeredBroadphase<T>::SetLayerBroadphase(CollisionLayer collisionLayer, std::shared_ptr<Broadphase<T>> broadphase) {
+	_layerBroadphases[(unsigned int)collisionLayer] = broadphase;
+}
+template<typename T>
+inline Broadphase<T>* LayeredBroadphase<T>::GetLayerBroadphase(CollisionLayer collisionLayer) {
+	return _layerBroadphases[(unsigned int)collisionLayer].get();
+}
+template<typename T>
+inline void LayeredBroadphase<T>::Build(const std::vector<T>& objects, const std::vector<Circle>& circleColliders,
+	const std::vector<CollisionLayer>& collisionLayers) {
+	for (unsigned int i = 0; i < layerCount; i++) {
+		_layerObjects[i].clear();
+		_layerColliders[i].clear();
+	}
+	for (unsigned int i = 0; i < objects.size(); i++) {
+		const unsigned int layer = (unsigned int)collisionLayers[i];
+		_layerObjects[layer].emplace_back(objects[i]);
+		_layerColliders[layer].emplace_back(circleColliders[i]);
+	}
+	for (unsigned int i = 0; i < layerCount; i++) {
+		if (_layerBroadphases[i]) {
+			_layerBroadphases[i]->Build(_layerObjects[i], _layerColliders[i]);
+		}
+	}
+}
+template<typename T>
+inline std::vector<T> LayeredBroadphase<T>::Query(Circle range, CollisionMask collisionMask) {
+	std::vector<T> objectsFound;
+	// A shared broadphase would also have returned the hits on the layers outside the mask.
+	// They are only counted, by testing the colliders kept from Build.
+	unsigned int unmaskedHitCount = 0;
+	for (unsigned int i = 0; i < layerCount; i++) {
+		if (!_layerBroadphases[i]) {
+			continue;
+		}
+		if (!(collisionMask & CollisionLayerBit((CollisionLayer)i))) {
+			for (unsigned int k = 0; k < _layerColliders[i].size(); k++) {
+				unmaskedHitCount += CircleIntersect(range, _layerColliders[i][k]) ? 1 : 0;
+			}
+			continue;
+		}
+		if (objectsFound.empty()) {
+			objectsFound = _layerBroadphases[i]->Query(range);
+		} else {
+			const std::vector<T> layerObjectsFound = _layerBroadphases[i]->Query(range);
+			objectsFound.insert(objectsFound.end(), layerObjectsFound.begin(), layerObjectsFound.end());
+		}
+	}
+	_queryCount.fetch_add(1, std::memory_order_relaxed);
+	_maskedResultCount.fetch_add(objectsFound.size(), std::memory_order_relaxed);
+	_unmaskedResultCount.fetch_add(objectsFound.size() + unmaskedHitCount, std::memory_order_relaxed);
+	return objectsFound;
+}
+template<typename T>
+inline BroadphaseStatistics LayeredBroadphase<T>::GetStatistics() {
+	BroadphaseStatistics statistics;
+	for (unsigned int i = 0; i < layerCount; i++) {
+		if (!_layerBroadphases[i]) {
+			continue;
+		}
+		const BroadphaseStatistics layerStatistics = _layerBroadphases[i]->GetStatistics();
+		for (unsigned int k = 0; k < statistics.depthHistogram.size(); k++) {
+			statistics.depthHistogram[k] += layerStatistics.depthHistogram[k];
+		}
+		statistics.nodeCount += layerStatistics.nodeCount;
+		statistics.objectCount += layerStatistics.objectCount;
+		statistics.overflowCount += layerStatistics.overflowCount;
+		statistics.queryCount += layerStatistics.queryCount;
+		statistics.queryResultCount += layerStatistics.queryResultCount;
+		statistics.reinsertCount += layerStatistics.reinsertCount;
+	}
+	statistics.layeredQueryCount = _queryCount.load(std::memory_order_relaxed);
+	statistics.maskedResultCount = _maskedResultCount.load(std::memory_order_relaxed);
+	statistics.unmaskedResultCount = _unmaskedResultCount.load(std::memory_order_relaxed);
+	return statistics;
+}
+template<typename T>
+inline void LayeredBroadphase<T>::Clear() {
+	for (unsigned int i = 0; i < layerCount; i++) {
+		if (_layerBroadphases[i]) {
+			_layerBroadphases[i]->Clear();
+		}
+	}
+	_queryCount.store(0, std::memory_order_relaxed);
+	_maskedResultCount.store(0, std::memory_order_relaxed);
+	_unmaskedResultCount.store(0, std::memory_order_relaxed);
+}
+template<typename T>
+inline void LayeredBroadphase<T>::Render() {
+	for (unsigned int i = 0; i < layerCount; i++) {
+		if (_layerBroadphases[i]) {
+			_layerBroadphases[i]->Render();
+		}
+	}
+}
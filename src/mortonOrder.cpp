@@ -0,0 +1,69 @@
+#include "mortonOrder.h"
+
+#include <algorithm>
+#include <array>
+
+static uint32_t SpreadBits(uint32_t value) {
+	value &= 0x0000ffff;
+	value = (value | (value << 8)) & 0x00ff00ff;
+	value = (value | (value << 4)) & 0x0f0f0f0f;
+	value = (value | (value << 2)) & 0x33333333;
+	value = (value | (value << 1)) & 0x55555555;
+	return value;
+}
+
+uint32_t MortonCode(uint32_t x, uint32_t y) {
+	return SpreadBits(x) | (SpreadBits(y) << 1);
+}
+
+void MortonOrder::SetBounds(Vector2<float> minimum, Vector2<float> maximum) {
+	_minimum = minimum;
+	_cellsPerUnit = {
+		65535.f / std::max(maximum.x - minimum.x, 1.f),
+		65535.f / std::max(maximum.y - minimum.y, 1.f) };
+}
+
+const std::vector<unsigned int>& MortonOrder::Sort(const std::vector<Vector2<float>>& positions) {
+	_keys.resize(positions.size());
+	_order.resize(positions.size());
+	for (unsigned int i = 0; i < positions.size(); i++) {
+		const float cellX = std::clamp((positions[i].x - _minimum.x) * _cellsPerUnit.x, 0.f, 65535.f);
+		const float cellY = std::clamp((positions[i].y - _minimum.y) * _cellsPerUnit.y, 0.f, 65535.f);
+		_keys[i] = MortonCode((uint32_t)cellX, (uint32_t)cellY);
+		_order[i] = i;
+	}
+	RadixSort();
+	return _order;
+}
+
+// Least significant byte first, each pass is a stable counting sort. Passes where
+// every key has the same byte are skipped, which is common for the high bytes.
+void MortonOrder::RadixSort() {
+	const unsigned int count = _keys.size();
+	_keysScratch.resize(count);
+	_orderScratch.resize(count);
+
+	for (unsigned int shift = 0; shift < 32; shift += 8) {
+		std::array<unsigned int, 256> offsets = {};
+		for (unsigned int i = 0; i < count; i++) {
+			offsets[(_keys[i] >> shift) & 0xff]++;
+		}
+		if (count == 0 || offsets[(_keys[0] >> shift) & 0xff] == count) {
+			continue;
+		}
+
+		unsigned int offset = 0;
+		for (unsigned int b = 0; b < offsets.size(); b++) {
+			const unsigned int bucketSize = offsets[b];
+			offsets[b] = offset;
+			offset += bucketSize;
+		}
+		for (unsigned int i = 0; i < count; i++) {
+			const unsigned int destination = offsets[(_keys[i] >> shift) & 0xff]++;
+			_keysScratch[destination] = _keys[i];
+			_orderScratch[destination] = _order[i];
+		}
+		_keys.swap(_keysScratch);
+		_order.swap(_orderScratch);
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "vector2.h"
+
+#include <cstdint>
+#include <vector>
+
+// Interleaves the bits of two 16 bit coordinates, x in the even bits and y in the odd bits.
+uint32_t MortonCode(uint32_t x, uint32_t y);
+
+// Sorts positions along a Z-order curve, so positions that are close in space end up
+// close in the sorted order. Positions outside the bounds are clamped to the edges.
+class MortonOrder {
+public:
+	MortonOrder() {}
+	~MortonOrder() {}
+
+	void SetBounds(Vector2<float> minimum, Vector2<float> maximum);
+
+	// Returns the indices of the positions in curve order. Equal codes keep their
+	// input order. The returned vector is reused by the next call.
+	const std::vector<unsigned int>& Sort(const std::vector<Vector2<float>>& positions);
+
+private:
+	void RadixSort();
+
+	std::vector<uint32_t> _keys;
+	std::vector<uint32_t> _keysScratch;
+	std::vector<unsigned int> _order;
+	std::vector<unsigned int> _orderScratch;
+
+	Vector2<float> _minimum = { 0.f, 0.f };
+	Vector2<float> _cellsPerUnit = { 1.f, 1.f };
+};
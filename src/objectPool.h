@@ -1,3 +1,4 @@
+#include <iterator>
 #include <vector>
 
 template<typename T>
@@ -12,11 +13,11 @@ public:
 	void PoolObject(T object);
 
 	T SpawnObject();
+	// Moves count objects to the end of spawnedObjects, the pool must hold at least that many.
+	void SpawnObjects(unsigned int count, std::vector<T>& spawnedObjects);
 
 private:
 	std::vector<T> _objectPool;
-
-	T _spawnedObject;
 };
 
 template<typename T>
@@ -41,9 +42,17 @@ inline void ObjectPool<T>::PoolObject(T object) {
 
 template<typename T>
 inline T ObjectPool<T>::SpawnObject() {
-	if (!IsEmpty()) {
-		_spawnedObject = _objectPool.back();
-		_objectPool.pop_back();
-		return _spawnedObject;
+	if (IsEmpty()) {
+		return T();
 	}
+	T spawnedObject = std::move(_objectPool.back());
+	_objectPool.pop_back();
+	return spawnedObject;
+}
+
+template<typename T>
+inline void ObjectPool<T>::SpawnObjects(unsigned int count, std::vector<T>& spawnedObjects) {
+	const auto first = _objectPool.end() - count;
+	spawnedObjects.insert(spawnedObjects.end(), std::make_move_iterator(first), std::make_move_iterator(_objectPool.end()));
+	_objectPool.erase(first, _objectPool.end());
 }
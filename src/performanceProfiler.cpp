@@ -0,0 +1,283 @@
+#include "performanceProfiler.h"
+
+#include "enemyBase.h"
+#include "enemyManager.h"
+#include "gameEngine.h"
+#include "imGuiManager.h"
+#include "projectile.h"
+#include "projectileManager.h"
+#include "timerManager.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<unsigned int> allocationCount = 0;
+
+void* operator new(std::size_t size) {
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	void* memory = std::malloc(size > 0 ? size : 1);
+	if (!memory) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void operator delete(void* memory) noexcept {
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+	std::free(memory);
+}
+
+unsigned int GetAllocationCount() {
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+const char* GetProfilerPhaseName(ProfilerPhase phase) {
+	switch (phase) {
+	case ProfilerPhase::SpatialSort:
+		return "Spatial sort";
+	case ProfilerPhase::QuadTreeBuild:
+		return "QuadTree build";
+	case ProfilerPhase::EnemyUpdate:
+		return "Enemy update";
+	case ProfilerPhase::EnemyAttack:
+		return "Enemy attack";
+	case ProfilerPhase::ProjectileUpdate:
+		return "Projectile update";
+	case ProfilerPhase::PlayerUpdate:
+		return "Player update";
+	case ProfilerPhase::TimerUpdate:
+		return "Timer update";
+	case ProfilerPhase::Render:
+		return "Render";
+	case ProfilerPhase::DebugDraw:
+		return "Debug draw";
+	case ProfilerPhase::ImGui:
+		return "ImGui";
+	default:
+		return "Unknown";
+	}
+}
+
+void PerformanceProfiler::BeginFrame() {
+	_frameStart = SDL_GetPerformanceCounter();
+	_allocationsAtFrameStart = GetAllocationCount();
+	{
+		std::lock_guard<std::mutex> lock(_statisticsMutex);
+		_phaseTimes.fill(0.f);
+	}
+	if (CountersOnThisThread()) {
+		for (unsigned int i = 0; i < _phaseCounters.size(); i++) {
+			_phaseCounters[i].Reset();
+		}
+	}
+}
+
+void PerformanceProfiler::EndFrame() {
+	const Uint64 frameTicks = SDL_GetPerformanceCounter() - _frameStart;
+	_frameIndex = (_frameIndex + 1) % frameHistorySize;
+	_frameTimes[_frameIndex] = (float)frameTicks * 1000.f / (float)SDL_GetPerformanceFrequency();
+	_framesRecorded = std::min(_framesRecorded + 1, frameHistorySize);
+
+	_allocationsThisFrame = GetAllocationCount() - _allocationsAtFrameStart;
+
+	std::copy(_frameTimes.begin(), _frameTimes.begin() + _framesRecorded, _sortedFrameTimes.begin());
+	std::sort(_sortedFrameTimes.begin(), _sortedFrameTimes.begin() + _framesRecorded);
+}
+
+void PerformanceProfiler::BeginPhase(ProfilerPhase phase) {
+	if (CountersOnThisThread()) {
+		_phaseCounterStart[(unsigned int)phase] = _hardwareCounters.Read();
+	}
+	_phaseStart[(unsigned int)phase] = SDL_GetPerformanceCounter();
+}
+
+void PerformanceProfiler::EndPhase(ProfilerPhase phase) {
+	const Uint64 phaseTicks = SDL_GetPerformanceCounter() - _phaseStart[(unsigned int)phase];
+	{
+		std::lock_guard<std::mutex> lock(_statisticsMutex);
+		_phaseTimes[(unsigned int)phase] += (float)phaseTicks * 1000.f / (float)SDL_GetPerformanceFrequency();
+	}
+	if (CountersOnThisThread()) {
+		_phaseCounters[(unsigned int)phase].Add(_phaseCounterStart[(unsigned int)phase], _hardwareCounters.Read());
+	}
+}
+
+void PerformanceProfiler::CaptureFrameStatistics() {
+	std::lock_guard<std::mutex> lock(_statisticsMutex);
+	for (unsigned int i = 0; i < (unsigned int)EnemyType::Count && i < typeCountLimit; i++) {
+		_activeEnemies[i] = enemyManager->GetActiveEnemyCount((EnemyType)i);
+		_pooledEnemies[i] = enemyManager->GetPooledEnemyCount((EnemyType)i);
+	}
+	for (unsigned int i = 0; i < (unsigned int)ProjectileType::Count && i < typeCountLimit; i++) {
+		_activeProjectiles[i] = projectileManager->GetActiveProjectileCount((ProjectileType)i);
+		_pooledProjectiles[i] = projectileManager->GetPooledProjectileCount((ProjectileType)i);
+	}
+	_enemyBroadphaseStatistics = enemyManager->GetEnemyBroadphase()->GetStatistics();
+	_projectileBroadphaseStatistics = projectileManager->GetProjectileBroadphase()->GetStatistics();
+	_enemyBroadphaseType = enemyManager->GetBroadphaseType();
+	_projectileBroadphaseType = projectileManager->GetBroadphaseType();
+	_spawnCostLastFrame = enemyManager->GetSpawnCostLastFrame();
+	_spawnQueueDepth = enemyManager->GetSpawnQueueDepth();
+	_spawnedLastFrame = enemyManager->GetSpawnedLastFrame();
+	_timerCount = timerManager->GetTimerCount();
+}
+
+void PerformanceProfiler::UpdateImgui() {
+	const char* windowName = "Performance";
+	std::lock_guard<std::mutex> lock(_statisticsMutex);
+
+	// Labels are formatted on the stack, heap strings would show up in the allocation count.
+	char overlay[64];
+	snprintf(overlay, sizeof(overlay), "p50 %f p95 %f p99 %f",
+		GetFramePercentile(0.5f), GetFramePercentile(0.95f), GetFramePercentile(0.99f));
+	imGuiHandler->PlotLines(windowName, "Frame (ms)", _frameTimes.data(), frameHistorySize,
+		(_frameIndex + 1) % frameHistorySize, overlay, 0.f, 50.f);
+
+	for (unsigned int i = 0; i < (unsigned int)ProfilerPhase::Count; i++) {
+		imGuiHandler->ShowFloatValue(windowName, GetProfilerPhaseName((ProfilerPhase)i), _phaseTimes[i]);
+	}
+	imGuiHandler->ShowIntValue(windowName, "Allocations", _allocationsThisFrame);
+	imGuiHandler->ShowIntValue(windowName, "Spawn queue", _spawnQueueDepth);
+	imGuiHandler->ShowFloatValue(windowName, "Spawn cost (ms)", _spawnCostLastFrame);
+
+	imGuiHandler->ShowText(windowName, "Enemies (active / pooled)");
+	const char* enemyNames[] = { "Boar", "CoralineDad" };
+	for (unsigned int i = 0; i < (unsigned int)EnemyType::Count && i < typeCountLimit; i++) {
+		imGuiHandler->ShowFloat2Value(windowName, enemyNames[i], _activeEnemies[i], _pooledEnemies[i]);
+	}
+	imGuiHandler->ShowText(windowName, "Projectiles (active / pooled)");
+	const char* projectileNames[] = { "EnemyProjectile", "PlayerProjectile" };
+	for (unsigned int i = 0; i < (unsigned int)ProjectileType::Count && i < typeCountLimit; i++) {
+		imGuiHandler->ShowFloat2Value(windowName, projectileNames[i], _activeProjectiles[i], _pooledProjectiles[i]);
+	}
+
+	const BroadphaseStatistics* broadphaseStatistics[] = { &_enemyBroadphaseStatistics, &_projectileBroadphaseStatistics };
+	const char* broadphaseNames[] = { "Enemy broadphase", "Projectile broadphase" };
+	const BroadphaseType broadphaseTypes[] = { _enemyBroadphaseType, _projectileBroadphaseType };
+	for (unsigned int i = 0; i < 2; i++) {
+		char broadphaseLabel[64];
+		snprintf(broadphaseLabel, sizeof(broadphaseLabel), "%s (%s)", broadphaseNames[i], GetBroadphaseName(broadphaseTypes[i]));
+		imGuiHandler->ShowText(windowName, broadphaseLabel);
+		imGuiHandler->ShowIntValue(windowName, "Nodes", broadphaseStatistics[i]->nodeCount);
+		imGuiHandler->ShowIntValue(windowName, "Overflow", broadphaseStatistics[i]->overflowCount);
+		imGuiHandler->ShowIntValue(windowName, "Reinserts", broadphaseStatistics[i]->reinsertCount);
+		imGuiHandler->ShowFloatValue(windowName, "Average query result", broadphaseStatistics[i]->GetAverageQueryResult());
+		if (broadphaseStatistics[i]->layeredQueryCount > 0) {
+			imGuiHandler->ShowFloat2Value(windowName, "Query results (masked / all layers)",
+				broadphaseStatistics[i]->GetAverageMaskedResult(), broadphaseStatistics[i]->GetAverageUnmaskedResult());
+		}
+
+		std::array<float, 16> depthHistogram = {};
+		for (unsigned int k = 0; k < depthHistogram.size(); k++) {
+			depthHistogram[k] = (float)broadphaseStatistics[i]->depthHistogram[k];
+		}
+		char histogramLabel[64];
+		snprintf(histogramLabel, sizeof(histogramLabel), "Depth##%s", broadphaseNames[i]);
+		imGuiHandler->PlotHistogram(windowName, histogramLabel, depthHistogram.data(), depthHistogram.size(),
+			nullptr, 0.f, FLT_MAX);
+	}
+}
+
+bool PerformanceProfiler::EnableHardwareCounters() {
+	_hardwareCounterThread = std::this_thread::get_id();
+	return _hardwareCounters.Open();
+}
+
+const bool PerformanceProfiler::HardwareCountersEnabled() const {
+	return _hardwareCounters.IsOpen();
+}
+
+const HardwareCounterSample& PerformanceProfiler::GetPhaseCounters(ProfilerPhase phase) const {
+	return _phaseCounters[(unsigned int)phase];
+}
+
+const float PerformanceProfiler::GetFrameTime() const {
+	return _frameTimes[_frameIndex];
+}
+
+const float PerformanceProfiler::GetFramePercentile(float percentile) const {
+	if (_framesRecorded == 0) {
+		return 0.f;
+	}
+	unsigned int index = (unsigned int)(percentile * (_framesRecorded - 1) + 0.5f);
+	return _sortedFrameTimes[std::min(index, _framesRecorded - 1)];
+}
+
+const float PerformanceProfiler::GetPhaseTime(ProfilerPhase phase) const {
+	std::lock_guard<std::mutex> lock(_statisticsMutex);
+	return _phaseTimes[(unsigned int)phase];
+}
+
+const unsigned int PerformanceProfiler::GetAllocationsThisFrame() const {
+	return _allocationsThisFrame;
+}
+
+const BroadphaseStatistics PerformanceProfiler::GetEnemyBroadphaseStatistics() const {
+	std::lock_guard<std::mutex> lock(_statisticsMutex);
+	return _enemyBroadphaseStatistics;
+}
+
+const BroadphaseStatistics PerformanceProfiler::GetProjectileBroadphaseStatistics() const {
+	std::lock_guard<std::mutex> lock(_statisticsMutex);
+	return _projectileBroadphaseStatistics;
+}
+
+const unsigned int PerformanceProfiler::GetActiveEnemyCount(unsigned int enemyType) const {
+	std::lock_guard<std::mutex> lock(_statisticsMutex);
+	return _activeEnemies[enemyType];
+}
+
+const unsigned int PerformanceProfiler::GetPooledEnemyCount(unsigned int enemyType) const {
+	std::lock_guard<std::mutex> lock(_statisticsMutex);
+	return _pooledEnemies[enemyType];
+}
+
+const unsigned int PerformanceProfiler::GetActiveProjectileCount(unsigned int projectileType) const {
+	std::lock_guard<std::mutex> lock(_statisticsMutex);
+	return _activeProjectiles[projectileType];
+}
+
+const unsigned int PerformanceProfiler::GetPooledProjectileCount(unsigned int projectileType) const {
+	std::lock_guard<std::mutex> lock(_statisticsMutex);
+	return _pooledProjectiles[projectileType];
+}
+
+const unsigned int PerformanceProfiler::GetSpawnQueueDepth() const {
+	std::lock_guard<std::mutex> lock(_statisticsMutex);
+	return _spawnQueueDepth;
+}
+
+const unsigned int PerformanceProfiler::GetSpawnedLastFrame() const {
+	std::lock_guard<std::mutex> lock(_statisticsMutex);
+	return _spawnedLastFrame;
+}
+
+const float PerformanceProfiler::GetSpawnCostLastFrame() const {
+	std::lock_guard<std::mutex> lock(_statisticsMutex);
+	return _spawnCostLastFrame;
+}
+
+const unsigned int PerformanceProfiler::GetTimerCount() const {
+	std::lock_guard<std::mutex> lock(_statisticsMutex);
+	return _timerCount;
+}
+
+// The counters are opened for one thread, phases timed on any other thread only get wall time.
+const bool PerformanceProfiler::CountersOnThisThread() const {
+	return _hardwareCounters.IsOpen() && std::this_thread::get_id() == _hardwareCounterThread;
+}
+
+ProfilerScope::ProfilerScope(ProfilerPhase profilerPhase) : phase(profilerPhase) {
+	performanceProfiler->BeginPhase(phase);
+}
+
+ProfilerScope::~ProfilerScope() {
+	performanceProfiler->EndPhase(phase);
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include "hardwareCounters.h"
+#include "broadphase.h"
+
+#include <SDL2/SDL.h>
+
+#include <array>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum class EnemyType;
+enum class ProjectileType;
+
+enum class ProfilerPhase {
+	SpatialSort,
+	QuadTreeBuild,
+	EnemyUpdate,
+	EnemyAttack,
+	ProjectileUpdate,
+	PlayerUpdate,
+	TimerUpdate,
+	Render,
+	DebugDraw,
+	ImGui,
+	Count
+};
+
+const char* GetProfilerPhaseName(ProfilerPhase phase);
+
+unsigned int GetAllocationCount();
+
+class PerformanceProfiler {
+public:
+	PerformanceProfiler() {}
+	~PerformanceProfiler() {}
+
+	void BeginFrame();
+	void EndFrame();
+
+	void BeginPhase(ProfilerPhase phase);
+	void EndPhase(ProfilerPhase phase);
+
+	void CaptureFrameStatistics();
+	void UpdateImgui();
+
+	bool EnableHardwareCounters();
+	const bool HardwareCountersEnabled() const;
+	const HardwareCounterSample& GetPhaseCounters(ProfilerPhase phase) const;
+
+	const float GetFrameTime() const;
+	const float GetFramePercentile(float percentile) const;
+	const float GetPhaseTime(ProfilerPhase phase) const;
+	const unsigned int GetAllocationsThisFrame() const;
+
+	const BroadphaseStatistics GetEnemyBroadphaseStatistics() const;
+	const BroadphaseStatistics GetProjectileBroadphaseStatistics() const;
+
+	const unsigned int GetActiveEnemyCount(unsigned int enemyType) const;
+	const unsigned int GetPooledEnemyCount(unsigned int enemyType) const;
+	const unsigned int GetActiveProjectileCount(unsigned int projectileType) const;
+	const unsigned int GetPooledProjectileCount(unsigned int projectileType) const;
+
+	const unsigned int GetSpawnQueueDepth() const;
+	const unsigned int GetSpawnedLastFrame() const;
+	const float GetSpawnCostLastFrame() const;
+	const unsigned int GetTimerCount() const;
+
+	static const unsigned int frameHistorySize = 240;
+	static const unsigned int typeCountLimit = 8;
+
+private:
+	const bool CountersOnThisThread() const;
+
+	// Guards the phase times and captured statistics, the simulation thread writes
+	// them while the main thread draws the overlay.
+	mutable std::mutex _statisticsMutex;
+
+	std::array<float, frameHistorySize> _frameTimes = {};
+	std::array<float, frameHistorySize> _sortedFrameTimes = {};
+
+	std::array<Uint64, (unsigned int)ProfilerPhase::Count> _phaseStart = {};
+	std::array<float, (unsigned int)ProfilerPhase::Count> _phaseTimes = {};
+
+	HardwareCounters _hardwareCounters;
+	std::thread::id _hardwareCounterThread;
+	std::array<HardwareCounterSample, (unsigned int)ProfilerPhase::Count> _phaseCounterStart;
+	std::array<HardwareCounterSample, (unsigned int)ProfilerPhase::Count> _phaseCounters;
+
+	std::array<unsigned int, typeCountLimit> _activeEnemies = {};
+	std::array<unsigned int, typeCountLimit> _pooledEnemies = {};
+	std::array<unsigned int, typeCountLimit> _activeProjectiles = {};
+	std::array<unsigned int, typeCountLimit> _pooledProjectiles = {};
+
+	BroadphaseStatistics _enemyBroadphaseStatistics;
+	BroadphaseStatistics _projectileBroadphaseStatistics;
+	BroadphaseType _enemyBroadphaseType = BroadphaseType::LooseQuadTree;
+	BroadphaseType _projectileBroadphaseType = BroadphaseType::LooseQuadTree;
+
+	float _spawnCostLastFrame = 0.f;
+	unsigned int _spawnQueueDepth = 0;
+	unsigned int _spawnedLastFrame = 0;
+	unsigned int _timerCount = 0;
+
+	Uint64 _frameStart = 0;
+
+	unsigned int _allocationsAtFrameStart = 0;
+	unsigned int _allocationsThisFrame = 0;
+	unsigned int _frameIndex = 0;
+	unsigned int _framesRecorded = 0;
+};
+
+struct ProfilerScope {
+	ProfilerScope(ProfilerPhase profilerPhase);
+	~ProfilerScope();
+
+	ProfilerPhase phase;
+};
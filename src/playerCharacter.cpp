@@ -33,6 +33,7 @@ PlayerCharacter::~PlayerCharacter() {}
 
 void PlayerCharacter::Init() {
 	_healthTextSprite->Init("res/roboto.ttf", 24, std::to_string(_currentHealth).c_str(), { 255, 255, 255, 255 });
+	_displayedHealth = _currentHealth;
 	_attackTimer = timerManager->CreateTimer(0.05f);
 	_regenerationTimer = timerManager->CreateTimer(0.5f);
 }
@@ -50,9 +51,23 @@ void PlayerCharacter::Render() {
 }
 
 void PlayerCharacter::RenderText() {
+	RenderHealthText(_currentHealth);
+}
+
+// The health text is only re-rasterized when the value changes, and only on the
+// render side since the simulation can run on another thread.
+void PlayerCharacter::RenderHealthText(int health) {
+	if (health != _displayedHealth) {
+		_healthTextSprite->ChangeText(std::to_string(health).c_str(), { 255, 255, 255, 255 });
+		_displayedHealth = health;
+	}
 	_healthTextSprite->Render();
 }
 
+void PlayerCharacter::AddRenderItem(std::vector<RenderItem>& renderItems) const {
+	renderItems.push_back({ _characterSprite.get(), _position, _orientation });
+}
+
 void PlayerCharacter::TakeDamage(unsigned int damageAmount) {
 	_currentHealth -= damageAmount;
 	
@@ -60,7 +75,6 @@ void PlayerCharacter::TakeDamage(unsigned int damageAmount) {
 		_currentHealth = 0;
 		ExecuteDeath();
 	}
-	_healthTextSprite->ChangeText(std::to_string(_currentHealth).c_str(), { 255, 255, 255, 255 });
 }
 
 void PlayerCharacter::ExecuteDeath() {
@@ -77,18 +91,14 @@ void PlayerCharacter::Respawn() {
 	_attackTimer->ResetTimer();
 
 	_currentHealth = _maxHealth;
-	_healthTextSprite->ChangeText(std::to_string(_currentHealth).c_str(), { 255, 255, 255, 255 });
 
 	enemyManager->RemoveAllEnemies();
 	projectileManager->RemoveAllProjectiles();
 }
 
 void PlayerCharacter::UpdateCollision() {
-	std::vector<std::shared_ptr<Projectile>> porjectilesHit = projectileManager->GetProjectileQuadTree()->Query(_circleCollider);
+	std::vector<std::shared_ptr<Projectile>> porjectilesHit = projectileManager->GetProjectileBroadphase()->Query(_circleCollider, _collisionMask);
 	for (unsigned int i = 0; i < porjectilesHit.size(); i++) {
-		if (porjectilesHit[i]->GetProjectileType() == ProjectileType::PlayerProjectile) {
-			continue;
-		}
 		TakeDamage(porjectilesHit[i]->GetProjectileDamage());
 		projectileManager->RemoveProjectile(porjectilesHit[i]->GetProjectileType(), porjectilesHit[i]->GetObjectID());
 	}
@@ -101,7 +111,6 @@ void PlayerCharacter::UpdateHealthRegen() {
 			if (_currentHealth > _maxHealth) {
 				_currentHealth = _maxHealth;
 			}
-			_healthTextSprite->ChangeText(std::to_string(_currentHealth).c_str(), { 255, 255, 255, 255 });
 			_regenerationTimer->ResetTimer();
 		}
 	}
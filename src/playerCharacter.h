@@ -1,8 +1,10 @@
 #pragma once
 #include "collision.h"
+#include "collisionLayers.h"
 #include "textSprite.h"
 #include "sprite.h"
 #include "vector2.h"
+#include "worldSnapshot.h"
 
 class Timer;
 
@@ -15,6 +17,8 @@ public:
 	void Update();
 	void Render();
 	void RenderText();
+	void RenderHealthText(int health);
+	void AddRenderItem(std::vector<RenderItem>& renderItems) const;
 
 	void ExecuteDeath();
 	void FireProjectile();
@@ -40,6 +44,8 @@ private:
 	void UpdateTarget();
 
 	Circle _circleCollider;
+	// The player is only hit by enemy projectiles, enemies attack through the weapon system.
+	const CollisionMask _collisionMask = CollisionLayerBit(CollisionLayer::EnemyProjectile);
 
 	const float _attackDamage = 10;
 	const float _movementSpeed = 100.f;
@@ -49,6 +55,7 @@ private:
 	float _orientation = 0.f;
 
 	int _currentHealth = 0;
+	int _displayedHealth = -1;
 
 	std::shared_ptr<Sprite> _characterSprite = nullptr;
 	std::shared_ptr<TextSprite> _healthTextSprite = nullptr;
@@ -5,26 +5,17 @@
 #include "enemyManager.h"
 #include "gameEngine.h"
 
-Projectile::Projectile(ProjectileType projectileType, unsigned int projectileDamage, unsigned int objectID) : ObjectBase(objectID) {
-	_sprite = new Sprite();
-	if (projectileType == ProjectileType::EnemyProjectile) {
-		_sprite->Load("res/sprites/Fireball.png");
-
-	} else if (projectileType == ProjectileType::PlayerProjectile) {
-		_sprite->Load("res/sprites/Arcaneball.png");
-	}
+Projectile::Projectile(ProjectileType projectileType, unsigned int projectileDamage, unsigned int objectID, Sprite* sprite) : ObjectBase(objectID) {
+	_sprite = sprite;
 	_projectileType = projectileType;
 	_projectileDamage = projectileDamage;
+	_collisionLayer = projectileType == ProjectileType::PlayerProjectile ?
+		CollisionLayer::PlayerProjectile : CollisionLayer::EnemyProjectile;
 
 	_circleCollider.radius = 8.f;
 	_circleCollider.position = _position;
 }
 
-Projectile::~Projectile() {
-	_sprite = nullptr;
-	delete _sprite;
-}
-
 void Projectile::Init() {}
 
 void Projectile::Update() {
@@ -36,10 +27,18 @@ void Projectile::Render() {
 	_sprite->RenderWithOrientation(_position, _orientation);
 }
 
+void Projectile::AddRenderItem(std::vector<RenderItem>& renderItems) const {
+	renderItems.push_back({ _sprite, _position, _orientation });
+}
+
 const Circle Projectile::GetCollider() const {
 	return _circleCollider;
 }
 
+const CollisionLayer Projectile::GetCollisionLayer() const {
+	return _collisionLayer;
+}
+
 const ProjectileType Projectile::GetProjectileType() const {
 	return _projectileType;
 }
@@ -1,8 +1,10 @@
 #pragma once
 #include "collision.h"
+#include "collisionLayers.h"
 #include "objectBase.h"
 #include "sprite.h"
 #include "vector2.h"
+#include "worldSnapshot.h"
 
 enum class ProjectileType {
 	EnemyProjectile,
@@ -12,14 +14,16 @@ enum class ProjectileType {
 
 class Projectile : public ObjectBase {
 public:
-	Projectile(ProjectileType damageType, unsigned int projectileDamage, unsigned int objectID);
-	~Projectile();
+	Projectile(ProjectileType damageType, unsigned int projectileDamage, unsigned int objectID, Sprite* sprite);
+	~Projectile() {}
 
 	void Init();
 	void Update();
 	void Render();
+	void AddRenderItem(std::vector<RenderItem>& renderItems) const;
 	
 	const Circle GetCollider() const;
+	const CollisionLayer GetCollisionLayer() const;
 	const ProjectileType GetProjectileType() const;
 	const unsigned int GetProjectileDamage() const;
 	
@@ -42,6 +46,7 @@ private:
 	const float _spriteCollisionOffset = 8.f;
 
 	ProjectileType _projectileType = ProjectileType::Count;	
+	CollisionLayer _collisionLayer = CollisionLayer::EnemyProjectile;
 
 	unsigned int _projectileDamage;
 
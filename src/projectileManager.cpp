@@ -1,24 +1,35 @@
 #include "projectileManager.h"
 
+#include "aabbTree.h"
 #include "dataStructuresAndMethods.h"
 #include "enemyManager.h"
 #include "enemyBase.h"
+#include "fastTrig.h"
 #include "gameEngine.h"
 #include "imGuiManager.h"
 #include "objectPool.h"
 #include "playerCharacter.h"
 #include "quadTree.h"
+#include "workerPool.h"
 
+// The sprites are loaded here on the render thread. Pools that run dry grow on the
+// simulation thread, and the new projectiles only point at the loaded sprites.
 ProjectileManager::ProjectileManager() {
-	QuadTreeNode quadTreeNode;
-	quadTreeNode.rectangle = AABB::makeFromPositionSize(
-		Vector2(windowWidth * 0.5f, windowHeight * 0.5f), windowHeight, windowWidth);
-	_projectileQuadTree = std::make_shared<QuadTree<std::shared_ptr<Projectile>>>(quadTreeNode, 25);
+	const char* spritePaths[] = { "res/sprites/Fireball.png", "res/sprites/Arcaneball.png" };
+	for (unsigned int i = 0; i < _projectileSprites.size(); i++) {
+		_projectileSprites[i] = std::make_shared<Sprite>();
+		_projectileSprites[i]->Load(spritePaths[i]);
+	}
+
+	_projectileBroadphase = std::make_shared<LayeredBroadphase<std::shared_ptr<Projectile>>>();
+	SetBroadphaseType(_broadphaseType);
 
 	for (unsigned int i = 0; i < (unsigned int)EnemyType::Count; i++) {
 		_projectilePools[(ProjectileType)i] = std::make_shared<ObjectPool<std::shared_ptr<Projectile>>>(_projectileAmountLimit);
 	}
 	_numberOfProjectileTypes = (unsigned int)EnemyType::Count;
+
+	_mortonOrder.SetBounds({ -100.f, -100.f }, { windowWidth + 100.f, windowHeight + 100.f });
 }
 
 ProjectileManager::~ProjectileManager() {}
@@ -35,14 +46,20 @@ void ProjectileManager::Init() {
 void ProjectileManager::Update() {
 	for (unsigned int i = 0; i < _activeProjectiles.size(); i++) {
 		_activeProjectiles[i]->Update();
-		if (CheckCollision(_activeProjectiles[i]->GetProjectileType(), i)) {
-			continue;
-		}
-		if (OutOfBorderX(_activeProjectiles[i]->GetPosition().x) ||
+	}
+	CheckCollisions();
+
+	// Removing reorders the active projectiles, so they are collected first.
+	_removedProjectiles.clear();
+	for (unsigned int i = 0; i < _activeProjectiles.size(); i++) {
+		if (_projectilesHit[i] || OutOfBorderX(_activeProjectiles[i]->GetPosition().x) ||
 			OutOfBorderY(_activeProjectiles[i]->GetPosition().y)) {
-			RemoveProjectile(_activeProjectiles[i]->GetProjectileType(), _activeProjectiles[i]->GetObjectID());
+			_removedProjectiles.emplace_back(_activeProjectiles[i]);
 		}
 	}
+	for (unsigned int i = 0; i < _removedProjectiles.size(); i++) {
+		RemoveProjectile(_removedProjectiles[i]->GetProjectileType(), _removedProjectiles[i]->GetObjectID());
+	}
 }
 
 void ProjectileManager::Render() {
@@ -51,44 +68,158 @@ void ProjectileManager::Render() {
 	}
 }
 
+void ProjectileManager::AddRenderItems(std::vector<RenderItem>& renderItems) const {
+	for (unsigned int i = 0; i < _activeProjectiles.size(); i++) {
+		_activeProjectiles[i]->AddRenderItem(renderItems);
+	}
+}
+
+void ProjectileManager::UpdateImgui() {
+	std::lock_guard<std::mutex> lock(_imguiMutex);
+	float spatialSortInterval = (float)_imguiSettings.spatialSortInterval;
+	imGuiHandler->Checkbox("Spatial sort", "Sort projectiles", _imguiSettings.spatialSortEnabled);
+	imGuiHandler->SliderFloat("Spatial sort", "Projectile interval (ticks)", spatialSortInterval, 1.f, 120.f);
+	_imguiSettings.spatialSortInterval = (unsigned int)spatialSortInterval;
+	imGuiHandler->ShowFloatValue("Spatial sort", "Projectile sort (ms)", _imguiSpatialSortTime);
+}
+
+void ProjectileManager::SyncImgui() {
+	std::lock_guard<std::mutex> lock(_imguiMutex);
+	_settings = _imguiSettings;
+	_imguiSpatialSortTime = _spatialSortTime;
+}
+
 void ProjectileManager::ClearProjectileQuadTree() {
-	_projectileQuadTree->Clear();
+	_projectileBroadphase->Clear();
 }
 
 void ProjectileManager::CreateNewProjectile(ProjectileType projectileType, float orientation, unsigned int projectileDamage, Vector2<float> direction, Vector2<float> position) {
-	_projectilePools[projectileType]->PoolObject(std::make_shared<Projectile>(projectileType, projectileDamage, _lastProjectileID));
+	_projectilePools[projectileType]->PoolObject(std::make_shared<Projectile>(projectileType, projectileDamage, _lastProjectileID,
+		_projectileSprites[(unsigned int)projectileType].get()));
+	_activeIndices.emplace_back(-1);
 	_lastProjectileID++;
 }
 
 void ProjectileManager::SpawnProjectile(ProjectileType projectileType, float orientation, unsigned int projectileDamage, Vector2<float> direction, Vector2<float> position) {
 	if (_projectilePools[projectileType]->IsEmpty()) {
 		CreateNewProjectile(projectileType, orientation, projectileDamage, direction, position);
-		_activeProjectiles.emplace_back(_projectilePools[projectileType]->SpawnObject());
-		_activeProjectiles.back()->ActivateProjectile(orientation, direction, position);
-	} else {
-		_activeProjectiles.emplace_back(_projectilePools[projectileType]->SpawnObject());
-		_activeProjectiles.back()->ActivateProjectile(orientation,direction, position);
-	}	
-}
-
-bool ProjectileManager::CheckCollision(ProjectileType projectileType, unsigned int projectileIndex) {
-	if (projectileType == ProjectileType::PlayerProjectile) {
-		std::vector<std::shared_ptr<EnemyBase>> enemiesHit = enemyManager->GetEnemyQuadTree()->Query(_activeProjectiles[projectileIndex]->GetCollider());
-		for (unsigned int i = 0; i < enemiesHit.size(); i++) {
-			if (enemiesHit[i]->TakeDamage(_activeProjectiles[projectileIndex]->GetProjectileDamage())) {
-				enemyManager->RemoveEnemy(enemiesHit[i]->GetEnemyType(), enemiesHit[i]->GetObjectID());
+	}
+	_activeProjectiles.emplace_back(_projectilePools[projectileType]->SpawnObject());
+	_activeProjectiles.back()->ActivateProjectile(orientation, direction, position);
+	_activeIndices[_activeProjectiles.back()->GetObjectID()] = _activeProjectiles.size() - 1;
+}
+
+// The pool is topped up and emptied into the active list in one move, only activating
+// the projectiles is left per shot.
+void ProjectileManager::SpawnProjectiles(ProjectileType projectileType, unsigned int projectileDamage, const std::vector<ProjectileSpawn>& projectileSpawns) {
+	const std::shared_ptr<ObjectPool<std::shared_ptr<Projectile>>>& projectilePool = _projectilePools[projectileType];
+	for (unsigned int i = projectilePool->PoolSize(); i < projectileSpawns.size(); i++) {
+		CreateNewProjectile(projectileType, 0.f, projectileDamage, Vector2<float>(0.f, 0.f), Vector2<float>(0.f, 0.f));
+	}
+	const unsigned int firstIndex = _activeProjectiles.size();
+	projectilePool->SpawnObjects(projectileSpawns.size(), _activeProjectiles);
+	for (unsigned int i = 0; i < projectileSpawns.size(); i++) {
+		Projectile* projectile = _activeProjectiles[firstIndex + i].get();
+		projectile->ActivateProjectile(projectileSpawns[i].orientation, projectileSpawns[i].direction, projectileSpawns[i].position);
+		_activeIndices[projectile->GetObjectID()] = firstIndex + i;
+	}
+}
+
+void ProjectileManager::SpawnBurst(ProjectileType projectileType, unsigned int projectileDamage, Vector2<float> position,
+	Vector2<float> direction, unsigned int count, float spacing) {
+	ProjectilePattern projectilePattern;
+	projectilePattern.type = ProjectilePatternType::Line;
+	projectilePattern.count = count;
+	projectilePattern.origin = position;
+	projectilePattern.direction = direction;
+	projectilePattern.spacing = spacing;
+	SpawnPattern(projectileType, projectileDamage, projectilePattern);
+}
+
+// Every shot is the pattern direction rotated by an angle and pushed out from the origin by a
+// distance. Both are filled per pattern type, then the rotations run as batches over the arrays.
+void ProjectileManager::SpawnPattern(ProjectileType projectileType, unsigned int projectileDamage, const ProjectilePattern& projectilePattern) {
+	const unsigned int count = projectilePattern.count;
+	if (count == 0) {
+		return;
+	}
+	_patternAngles.resize(count);
+	_patternDistances.resize(count);
+	_patternSines.resize(count);
+	_patternCosines.resize(count);
+	_patternSpawns.resize(count);
+
+	float angleStep = 0.f;
+	float firstAngle = 0.f;
+	float distanceStep = 0.f;
+	switch (projectilePattern.type) {
+	case ProjectilePatternType::Spread:
+		angleStep = count > 1 ? projectilePattern.arc / (count - 1) : 0.f;
+		firstAngle = count > 1 ? -projectilePattern.arc * 0.5f : 0.f;
+		break;
+
+	case ProjectilePatternType::Ring:
+		angleStep = (float)(2.0 * PI / count);
+		break;
+
+	case ProjectilePatternType::Spiral:
+		angleStep = projectilePattern.arc;
+		distanceStep = projectilePattern.spacing;
+		break;
+
+	default:
+		distanceStep = projectilePattern.spacing;
+		break;
+	}
+	for (unsigned int i = 0; i < count; i++) {
+		_patternAngles[i] = firstAngle + angleStep * i;
+		_patternDistances[i] = projectilePattern.radius + distanceStep * i;
+	}
+	FastSinCosBatch(_patternAngles.data(), _patternSines.data(), _patternCosines.data(), count);
+
+	const Vector2<float> direction = projectilePattern.direction.normalized();
+	const float orientation = VectorAsOrientation(direction);
+	for (unsigned int i = 0; i < count; i++) {
+		const Vector2<float> shotDirection(
+			direction.x * _patternCosines[i] - direction.y * _patternSines[i],
+			direction.x * _patternSines[i] + direction.y * _patternCosines[i]);
+		_patternSpawns[i].direction = shotDirection;
+		_patternSpawns[i].position = projectilePattern.origin + shotDirection * _patternDistances[i];
+		// Rotating the direction turns the orientation by the same angle.
+		_patternSpawns[i].orientation = orientation + _patternAngles[i];
+	}
+	SpawnProjectiles(projectileType, projectileDamage, _patternSpawns);
+}
+
+// Player projectiles are tested against the enemy broadphase on the worker threads.
+// Workers only read the broadphase and add damage to the enemies' slots, deaths and
+// removals are applied afterwards on this thread in active list order.
+void ProjectileManager::CheckCollisions() {
+	enemyManager->PrepareDamageSlots();
+	_projectilesHit.assign(_activeProjectiles.size(), 0);
+
+	Broadphase<std::shared_ptr<EnemyBase>>* enemyBroadphase = enemyManager->GetEnemyBroadphase().get();
+	workerPool->ParallelFor(_activeProjectiles.size(), _collisionGrainSize, [&](unsigned int begin, unsigned int end) {
+		// One result vector per worker, kept between ticks so the queries stop allocating.
+		static thread_local std::vector<std::shared_ptr<EnemyBase>> enemiesHit;
+		for (unsigned int i = begin; i < end; i++) {
+			if (_activeProjectiles[i]->GetProjectileType() != ProjectileType::PlayerProjectile) {
+				continue;
 			}
+			enemyBroadphase->Query(_activeProjectiles[i]->GetCollider(), enemiesHit);
+			for (unsigned int k = 0; k < enemiesHit.size(); k++) {
+				enemyManager->AccumulateDamage(enemiesHit[k]->GetObjectID(), _activeProjectiles[i]->GetProjectileDamage());
+			}
+			_projectilesHit[i] = !enemiesHit.empty();
 		}
-		if (enemiesHit.size() > 0) {
-			RemoveProjectile(projectileType, _activeProjectiles[projectileIndex]->GetObjectID());
-			return true;
-		}
-	}
-	return false;
+		enemiesHit.clear();
+	});
+	enemyManager->ResolveAccumulatedDamage();
 }
 
 void ProjectileManager::RemoveAllProjectiles() {
 	while (_activeProjectiles.size() > 0) {
+		_activeIndices[_activeProjectiles.back()->GetObjectID()] = -1;
 		_activeProjectiles.back()->DeactivateProjectile();
 		_projectilePools[_activeProjectiles.back()->GetProjectileType()]->PoolObject(_activeProjectiles.back());
 		_activeProjectiles.pop_back();
@@ -96,86 +227,106 @@ void ProjectileManager::RemoveAllProjectiles() {
 }
 
 void ProjectileManager::RemoveProjectile(ProjectileType projectileType, unsigned int projectileID) {
-	if (_activeProjectiles.empty()) {
+	if (projectileID >= _activeIndices.size() || _activeIndices[projectileID] < 0) {
 		return;
-	} else if (_activeProjectiles.size() > 1) {
-		QuickSort(0, _activeProjectiles.size() - 1);
-		_latestProjectileIndex = BinarySearch(0, _activeProjectiles.size() - 1, projectileID);
-		if (_latestProjectileIndex >= 0) {
-			_activeProjectiles[_latestProjectileIndex]->DeactivateProjectile();
-			_projectilePools[projectileType]->PoolObject(_activeProjectiles[_latestProjectileIndex]);
-			std::swap(_activeProjectiles[_latestProjectileIndex], _activeProjectiles.back());
-		}
-		_latestProjectileIndex = -1;
 	}
+	const int projectileIndex = _activeIndices[projectileID];
+	_activeProjectiles[projectileIndex]->DeactivateProjectile();
+	_projectilePools[projectileType]->PoolObject(_activeProjectiles[projectileIndex]);
+
+	_activeIndices[_activeProjectiles.back()->GetObjectID()] = projectileIndex;
+	_activeIndices[projectileID] = -1;
+	std::swap(_activeProjectiles[projectileIndex], _activeProjectiles.back());
 	_activeProjectiles.pop_back();
 }
 
 void ProjectileManager::UpdateQuadTree() {
+	_projectileColliders.clear();
+	_projectileLayers.clear();
 	for (unsigned int i = 0; i < _activeProjectiles.size(); i++) {
-		_projectileQuadTree->Insert(_activeProjectiles[i], _activeProjectiles[i]->GetCollider());
+		_projectileColliders.emplace_back(_activeProjectiles[i]->GetCollider());
+		_projectileLayers.emplace_back(_activeProjectiles[i]->GetCollisionLayer());
 	}
+	_projectileBroadphase->Build(_activeProjectiles, _projectileColliders, _projectileLayers);
 }
 
-std::shared_ptr<QuadTree<std::shared_ptr<Projectile>>> ProjectileManager::GetProjectileQuadTree() {
-	return _projectileQuadTree;
+std::shared_ptr<LayeredBroadphase<std::shared_ptr<Projectile>>> ProjectileManager::GetProjectileBroadphase() {
+	return _projectileBroadphase;
 }
 
-int ProjectileManager::BinarySearch(int low, int high, int targetID) {
-	while (low <= high) {
-		int mid = low + (high - low) / 2;
+void ProjectileManager::SetBroadphaseType(BroadphaseType broadphaseType) {
+	QuadTreeNode quadTreeNode;
+	quadTreeNode.rectangle = AABB::makeFromPositionSize(
+		Vector2(windowWidth * 0.5f, windowHeight * 0.5f), windowHeight, windowWidth);
+	const CollisionLayer projectileLayers[] = { CollisionLayer::PlayerProjectile, CollisionLayer::EnemyProjectile };
+	for (CollisionLayer projectileLayer : projectileLayers) {
+		std::shared_ptr<Broadphase<std::shared_ptr<Projectile>>> layerBroadphase;
+		switch (broadphaseType) {
+		case BroadphaseType::QuadTree:
+			layerBroadphase = std::make_shared<QuadTree<std::shared_ptr<Projectile>>>(quadTreeNode, 25);
+			break;
 
-		if (_activeProjectiles[mid]->GetObjectID() == targetID) {
-			return mid;
-		}
+		case BroadphaseType::AABBTree:
+			layerBroadphase = std::make_shared<AABBTree<std::shared_ptr<Projectile>>>(8.f);
+			break;
 
-		if (_activeProjectiles[mid]->GetObjectID() < targetID) {
-			low = mid + 1;
-		} else {
-			high = mid - 1;
+		default:
+			layerBroadphase = std::make_shared<QuadTree<std::shared_ptr<Projectile>>>(quadTreeNode, 25, 2.f);
+			break;
 		}
+		_projectileBroadphase->SetLayerBroadphase(projectileLayer, layerBroadphase);
 	}
-	return -1;
+	_broadphaseType = broadphaseType;
 }
 
-int ProjectileManager::Partition(int start, int end) {
-	unsigned int pivot = _activeProjectiles[start]->GetObjectID();
+const BroadphaseType ProjectileManager::GetBroadphaseType() const {
+	return _broadphaseType;
+}
 
-	int count = 0;
-	for (int i = start + 1; i <= end; i++) {
-		if (_activeProjectiles[i]->GetObjectID() <= pivot) {
-			count++;
+unsigned int ProjectileManager::GetActiveProjectileCount(ProjectileType projectileType) {
+	unsigned int activeCount = 0;
+	for (unsigned int i = 0; i < _activeProjectiles.size(); i++) {
+		if (_activeProjectiles[i]->GetProjectileType() == projectileType) {
+			activeCount++;
 		}
 	}
+	return activeCount;
+}
 
-	int pivotIndex = start + count;
-	std::swap(_activeProjectiles[pivotIndex], _activeProjectiles[start]);
-
-	int i = start, k = end;
-
-	while (i < pivotIndex && k > pivotIndex) {
+unsigned int ProjectileManager::GetPooledProjectileCount(ProjectileType projectileType) {
+	return _projectilePools[projectileType]->PoolSize();
+}
 
-		while (_activeProjectiles[i]->GetObjectID() <= pivot) {
-			i++;
-		}
+void ProjectileManager::UpdateSpatialOrder() {
+	if (!_settings.spatialSortEnabled || _activeProjectiles.size() < 2 || frameNumber % _settings.spatialSortInterval != 0) {
+		return;
+	}
+	const Uint64 sortStart = SDL_GetPerformanceCounter();
 
-		while (_activeProjectiles[k]->GetObjectID() > pivot) {
-			k--;
-		}
+	_projectilePositions.clear();
+	for (unsigned int i = 0; i < _activeProjectiles.size(); i++) {
+		_projectilePositions.emplace_back(_activeProjectiles[i]->GetPosition());
+	}
+	const std::vector<unsigned int>& order = _mortonOrder.Sort(_projectilePositions);
 
-		if (i < pivotIndex && k > pivotIndex) {
-			std::swap(_activeProjectiles[i++], _activeProjectiles[k--]);
-		}
+	_sortedProjectiles.clear();
+	for (unsigned int i = 0; i < order.size(); i++) {
+		_sortedProjectiles.emplace_back(std::move(_activeProjectiles[order[i]]));
+	}
+	_activeProjectiles.swap(_sortedProjectiles);
+	for (unsigned int i = 0; i < _activeProjectiles.size(); i++) {
+		_activeIndices[_activeProjectiles[i]->GetObjectID()] = i;
 	}
-	return pivotIndex;
+
+	_spatialSortTime = (float)(SDL_GetPerformanceCounter() - sortStart) * 1000.f / (float)SDL_GetPerformanceFrequency();
 }
 
-void ProjectileManager::QuickSort(int start, int end) {
-	if (start >= end) {
-		return;
-	}
-	int p = Partition(start, end);
+void ProjectileManager::SetSpatialSortEnabled(bool spatialSortEnabled) {
+	std::lock_guard<std::mutex> lock(_imguiMutex);
+	_settings.spatialSortEnabled = spatialSortEnabled;
+	_imguiSettings.spatialSortEnabled = spatialSortEnabled;
+}
 
-	QuickSort(start, p - 1);
-	QuickSort(p + 1, end);
+const float ProjectileManager::GetSpatialSortTime() const {
+	return _spatialSortTime;
 }
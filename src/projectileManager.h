@@ -1,11 +1,46 @@
 #pragma once
+#include "broadphase.h"
+#include "layeredBroadphase.h"
+#include "mortonOrder.h"
 #include "projectile.h"
+#include "worldSnapshot.h"
 
+#include <array>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
 template<typename T> class ObjectPool;
-template<typename T> class QuadTree;
+template<typename T> class Broadphase;
+
+struct ProjectileSpawn {
+	Vector2<float> position = Vector2<float>(0.f, 0.f);
+	Vector2<float> direction = Vector2<float>(0.f, 0.f);
+	float orientation = 0.f;
+};
+
+enum class ProjectilePatternType {
+	Spread,
+	Ring,
+	Spiral,
+	Line,
+	Count
+};
+
+// Describes a group of shots fired in one call. Angles are in radians and rotate the
+// shots away from direction, which also fixes where the ring and spiral start.
+struct ProjectilePattern {
+	ProjectilePatternType type = ProjectilePatternType::Ring;
+	unsigned int count = 1;
+	Vector2<float> origin = Vector2<float>(0.f, 0.f);
+	Vector2<float> direction = Vector2<float>(0.f, -1.f);
+	// Spread: the whole fan from the first to the last shot. Spiral: between two shots.
+	float arc = 0.f;
+	// Line and Spiral: how much further along its direction every shot starts.
+	float spacing = 0.f;
+	// Distance from the origin the first shot starts at.
+	float radius = 0.f;
+};
 
 class ProjectileManager {
 public:
@@ -15,36 +50,93 @@ public:
 	void Init();
 	void Update();
 	void Render();
+	void AddRenderItems(std::vector<RenderItem>& renderItems) const;
+	void UpdateImgui();
+	// Applies what the overlay changed and copies what it shows, once per tick on
+	// the simulation thread.
+	void SyncImgui();
 
-	bool CheckCollision(ProjectileType projectileType, unsigned int projectileIndex);
+	void CheckCollisions();
 
 	void ClearProjectileQuadTree();
 	void CreateNewProjectile(ProjectileType projectileType, float orientation, unsigned int projectileDamage,
 		Vector2<float> direction, Vector2<float> position);
 	void SpawnProjectile(ProjectileType projectileType, float orientation, unsigned int projectileDamage, Vector2<float> direction, Vector2<float> position);
+	// Spawns a group of projectiles of one type, the pool is grown once for the whole group.
+	void SpawnProjectiles(ProjectileType projectileType, unsigned int projectileDamage, const std::vector<ProjectileSpawn>& projectileSpawns);
+	// Count projectiles in a line along direction, spacing apart.
+	void SpawnBurst(ProjectileType projectileType, unsigned int projectileDamage, Vector2<float> position,
+		Vector2<float> direction, unsigned int count, float spacing);
+	void SpawnPattern(ProjectileType projectileType, unsigned int projectileDamage, const ProjectilePattern& projectilePattern);
 	void RemoveAllProjectiles();
 	void RemoveProjectile(ProjectileType projectileType, unsigned int projectileIndex);
 
 	void UpdateQuadTree();
 
-	std::shared_ptr<QuadTree<std::shared_ptr<Projectile>>> GetProjectileQuadTree();
+	// Same as EnemyManager::UpdateSpatialOrder, projectiles move faster so they are sorted more often.
+	void UpdateSpatialOrder();
+	void SetSpatialSortEnabled(bool spatialSortEnabled);
+	const float GetSpatialSortTime() const;
 
-	int BinarySearch(int low, int high, int targetID);
+	// Player and enemy projectiles are on separate layers, queries pick theirs with a mask.
+	std::shared_ptr<LayeredBroadphase<std::shared_ptr<Projectile>>> GetProjectileBroadphase();
+	void SetBroadphaseType(BroadphaseType broadphaseType);
+	const BroadphaseType GetBroadphaseType() const;
 
-	int Partition(int start, int end);
-	void QuickSort(int start, int end);
+	unsigned int GetActiveProjectileCount(ProjectileType projectileType);
+	unsigned int GetPooledProjectileCount(ProjectileType projectileType);
 
 private:
+	// Tunables the overlay can change while the simulation thread ticks.
+	struct Settings {
+		unsigned int spatialSortInterval = 10;
+		bool spatialSortEnabled = true;
+	};
+
 	std::unordered_map<ProjectileType, std::shared_ptr<ObjectPool<std::shared_ptr<Projectile>>>> _projectilePools;
 	std::vector<std::shared_ptr<Projectile>> _activeProjectiles;
+	std::vector<Circle> _projectileColliders;
+	std::vector<CollisionLayer> _projectileLayers;
 
-	std::shared_ptr<QuadTree<std::shared_ptr<Projectile>>> _projectileQuadTree;
+	// Index into the active projectiles by object ID, -1 while the projectile is pooled.
+	std::vector<int> _activeIndices;
+
+	MortonOrder _mortonOrder;
+	std::vector<Vector2<float>> _projectilePositions;
+	std::vector<std::shared_ptr<Projectile>> _sortedProjectiles;
+
+	// Scratch arrays for building patterns, kept between calls so a wave does not allocate.
+	std::vector<ProjectileSpawn> _patternSpawns;
+	std::vector<float> _patternAngles;
+	std::vector<float> _patternSines;
+	std::vector<float> _patternCosines;
+	std::vector<float> _patternDistances;
+
+	// Filled by the collision pass, one entry per active projectile.
+	std::vector<unsigned char> _projectilesHit;
+	std::vector<std::shared_ptr<Projectile>> _removedProjectiles;
+
+	// One sprite per type, shared by every projectile of the type.
+	std::array<std::shared_ptr<Sprite>, (unsigned int)ProjectileType::Count> _projectileSprites;
+
+	std::shared_ptr<LayeredBroadphase<std::shared_ptr<Projectile>>> _projectileBroadphase;
+	BroadphaseType _broadphaseType = BroadphaseType::LooseQuadTree;
+
+	// Projectiles per collision task.
+	const unsigned int _collisionGrainSize = 64;
 
 	unsigned int _projectileAmountLimit = 2000;
 	unsigned int _numberOfProjectileTypes = 0;
 
 	unsigned int _lastProjectileID = 0;
-	int _latestProjectileIndex = -1;
 
+	float _spatialSortTime = 0.f;
+
+	// The simulation reads _settings, the overlay edits _imguiSettings and shows
+	// _imguiSpatialSortTime. SyncImgui exchanges them under _imguiMutex.
+	Settings _settings;
+	Settings _imguiSettings;
+	float _imguiSpatialSortTime = 0.f;
+	std::mutex _imguiMutex;
 };
 
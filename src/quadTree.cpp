@@ -1,9 +1,14 @@
 #include "quadTree.h"
 
+void QuadTreeNode::SetLooseness(float looseness) {
+	looseRectangle = AABB::makeFromPositionSize(rectangle.position,
+		rectangle.height * looseness, rectangle.width * looseness);
+}
+
 bool QuadTreeNode::Contains(Circle circleCollider) {
-	return AABBCircleIntersect(rectangle, circleCollider);
+	return AABBContainsCircle(looseRectangle, circleCollider);
 }
 
 bool QuadTreeNode::Intersect(Circle range) {
-	return AABBCircleIntersect(rectangle, range);
+	return AABBCircleIntersect(looseRectangle, range);
 }
@@ -1,52 +1,106 @@
 #pragma once
+#include "broadphase.h"
 #include "collision.h"
 #include "vector2.h"
 
 #include <array>
+#include <atomic>
 #include <vector>
 
 #include "debugDrawer.h"
 #include "gameEngine.h"
 #include "projectileManager.h"
+#include "workerPool.h"
 
 struct QuadTreeNode {
 	AABB rectangle;
+	AABB looseRectangle;
+
+	void SetLooseness(float looseness);
 
 	bool Contains(Circle circleCollider);
 	bool Intersect(Circle range);
 };
 
+// Objects are stored in the deepest node whose loose bounds fully contain their collider.
+// A looseness above 1 enlarges every node so colliders straddling a cell boundary can
+// still move down the tree; objects outside the root go into an overflow list.
 template<typename T> 
-class QuadTree {
+class QuadTree : public Broadphase<T> {
 public:
-	QuadTree(QuadTreeNode boundary, unsigned int capacity);
+	QuadTree(QuadTreeNode boundary, unsigned int capacity, float looseness = 1.f, unsigned int depth = 0);
 	~QuadTree();
 
-	bool Insert(T object, Circle circleCollider);
+	bool Insert(T object, Circle circleCollider) override;
+	void Build(const std::vector<T>& objects, const std::vector<Circle>& circleColliders) override;
+
+	std::vector<T> Query(Circle range) override;
+	void Query(Circle range, std::vector<T>& objectsFound) override;
+	// Best first: nodes are visited by distance to their loose bounds and the search stops
+	// once the closest unvisited node is further away than the count-th hit.
+	void QueryNearest(Vector2<float> point, unsigned int count, std::vector<BroadphaseHit<T>>& hits) override;
+	void Raycast(Vector2<float> start, Vector2<float> end, std::vector<BroadphaseHit<T>>& hits) override;
+	void QueryCone(const Cone& cone, std::vector<T>& objectsFound) override;
 
-	std::vector<T> Query(Circle range);
+	BroadphaseStatistics GetStatistics() override;
 
-	void Clear();
+	void Clear() override;
 	void Undevide();
 
 	void Subdevide();
 
-	void Render();
+	void Render() override;
+
+	static const unsigned int maxDepth = 10;
+
+	// Builds below this many objects stay on the calling thread.
+	static const unsigned int parallelBuildThreshold = 2048;
+	// The top levels are split on the calling thread, every subtree below is built by one task.
+	static const unsigned int parallelSplitDepth = 2;
 
 private:
+	struct BuildJob {
+		QuadTree<T>* node = nullptr;
+		std::vector<unsigned int> indices;
+	};
+
+	bool PartitionNode(const std::vector<unsigned int>& indices, const std::vector<T>& objects,
+		const std::vector<Circle>& circleColliders, std::array<std::vector<unsigned int>, 4>& childIndices, bool parallel);
+	void BuildNode(const std::vector<unsigned int>& indices, const std::vector<T>& objects, const std::vector<Circle>& circleColliders);
+	void CollectBuildJobs(const std::vector<unsigned int>& indices, const std::vector<T>& objects,
+		const std::vector<Circle>& circleColliders, std::vector<BuildJob>& buildJobs);
+	unsigned int GetChildIndex(const Circle& circleCollider) const;
+
+	void InsertNode(T& object, Circle& circleCollider);
+	void QueryNode(Circle& range, std::vector<T>& objectsFound);
+	void RaycastNode(Vector2<float> start, Vector2<float> end, float length, std::vector<BroadphaseHit<T>>& hits);
+	void QueryConeNode(const Cone& cone, std::vector<T>& objectsFound);
+	void CollectStatistics(BroadphaseStatistics& statistics);
+
 	bool _divided = false;
 
+	float _looseness = 1.f;
+
 	unsigned int _capacity = 0;
+	unsigned int _depth = 0;
+	std::atomic<unsigned int> _queryCount = 0;
+	std::atomic<unsigned int> _queryResultCount = 0;
 	QuadTreeNode _quadTreeNode;
 
 	std::array<std::shared_ptr<QuadTree<T>>, 4> _quadTreeChildren;
 	std::vector<T> _objectsInserted;
 	std::vector<Circle> _circleColliders;
+
+	std::vector<T> _overflowObjects;
+	std::vector<Circle> _overflowColliders;
 };
 template<typename T>
-inline QuadTree<T>::QuadTree(QuadTreeNode boundary, unsigned int capacity) {
+inline QuadTree<T>::QuadTree(QuadTreeNode boundary, unsigned int capacity, float looseness, unsigned int depth) {
 	_quadTreeNode = boundary;
+	_quadTreeNode.SetLooseness(looseness);
 	_capacity = capacity;
+	_looseness = looseness;
+	_depth = depth;
 
 	_quadTreeChildren[0] = nullptr;
 	_quadTreeChildren[1] = nullptr;
@@ -61,62 +115,332 @@ inline QuadTree<T>::~QuadTree() {
 template<typename T>
 inline bool QuadTree<T>::Insert(T object, Circle circleCollider) {
 	if (!_quadTreeNode.Contains(circleCollider)) {
+		_overflowObjects.emplace_back(object);
+		_overflowColliders.emplace_back(circleCollider);
+		return false;
+	}
+	InsertNode(object, circleCollider);
+	return true;
+}
+// Gives the same tree as inserting the objects one by one in order. A node keeps the
+// first objects up to its capacity and the ones straddling its children, every child
+// gets the ordered subsequence of the rest that falls in it. The children don't
+// depend on each other so the subtrees are built in parallel.
+template<typename T>
+inline void QuadTree<T>::Build(const std::vector<T>& objects, const std::vector<Circle>& circleColliders) {
+	if (_divided || !_objectsInserted.empty() || !_overflowObjects.empty()) {
+		Broadphase<T>::Build(objects, circleColliders);
+		return;
+	}
+	const bool parallel = objects.size() >= parallelBuildThreshold && workerPool->GetThreadCount() > 1;
+
+	std::vector<unsigned char> contained(objects.size());
+	auto classify = [&](unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; i++) {
+			contained[i] = _quadTreeNode.Contains(circleColliders[i]);
+		}
+	};
+	if (parallel) {
+		workerPool->ParallelFor(objects.size(), parallelBuildThreshold, classify);
+	} else {
+		classify(0, objects.size());
+	}
+
+	std::vector<unsigned int> indices;
+	indices.reserve(objects.size());
+	for (unsigned int i = 0; i < objects.size(); i++) {
+		if (contained[i]) {
+			indices.emplace_back(i);
+		} else {
+			_overflowObjects.emplace_back(objects[i]);
+			_overflowColliders.emplace_back(circleColliders[i]);
+		}
+	}
+	if (!parallel) {
+		BuildNode(indices, objects, circleColliders);
+		return;
+	}
+
+	std::vector<BuildJob> buildJobs;
+	CollectBuildJobs(indices, objects, circleColliders, buildJobs);
+	workerPool->Run(buildJobs.size(), [&](unsigned int jobIndex) {
+		buildJobs[jobIndex].node->BuildNode(buildJobs[jobIndex].indices, objects, circleColliders);
+	});
+}
+template<typename T>
+inline bool QuadTree<T>::PartitionNode(const std::vector<unsigned int>& indices, const std::vector<T>& objects,
+	const std::vector<Circle>& circleColliders, std::array<std::vector<unsigned int>, 4>& childIndices, bool parallel) {
+	if (indices.size() <= _capacity || _depth >= maxDepth) {
+		for (unsigned int i = 0; i < indices.size(); i++) {
+			_objectsInserted.emplace_back(objects[indices[i]]);
+			_circleColliders.emplace_back(circleColliders[indices[i]]);
+		}
 		return false;
 	}
-	if (_objectsInserted.size() < _capacity) {
-		_objectsInserted.emplace_back(object);
-		_circleColliders.emplace_back(circleCollider);
-		return true;
+	for (unsigned int i = 0; i < _capacity; i++) {
+		_objectsInserted.emplace_back(objects[indices[i]]);
+		_circleColliders.emplace_back(circleColliders[indices[i]]);
+	}
+	Subdevide();
+
+	// 0-3 is the child the object goes to, 4 means it straddles the children and stays here.
+	std::vector<unsigned char> childSlots(indices.size() - _capacity);
+	auto classify = [&](unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; i++) {
+			const Circle& circleCollider = circleColliders[indices[_capacity + i]];
+			const unsigned int childIndex = GetChildIndex(circleCollider);
+			childSlots[i] = _quadTreeChildren[childIndex]->_quadTreeNode.Contains(circleCollider) ? childIndex : 4;
+		}
+	};
+	if (parallel && childSlots.size() >= parallelBuildThreshold) {
+		workerPool->ParallelFor(childSlots.size(), parallelBuildThreshold, classify);
 	} else {
-		if (!_divided) {
-			Subdevide();
+		classify(0, childSlots.size());
+	}
+
+	for (unsigned int i = 0; i < childSlots.size(); i++) {
+		const unsigned int objectIndex = indices[_capacity + i];
+		if (childSlots[i] < 4) {
+			childIndices[childSlots[i]].emplace_back(objectIndex);
+		} else {
+			_objectsInserted.emplace_back(objects[objectIndex]);
+			_circleColliders.emplace_back(circleColliders[objectIndex]);
+		}
+	}
+	return true;
+}
+template<typename T>
+inline void QuadTree<T>::BuildNode(const std::vector<unsigned int>& indices, const std::vector<T>& objects,
+	const std::vector<Circle>& circleColliders) {
+	std::array<std::vector<unsigned int>, 4> childIndices;
+	if (!PartitionNode(indices, objects, circleColliders, childIndices, false)) {
+		return;
+	}
+	for (unsigned int i = 0; i < _quadTreeChildren.size(); i++) {
+		_quadTreeChildren[i]->BuildNode(childIndices[i], objects, circleColliders);
+	}
+}
+template<typename T>
+inline void QuadTree<T>::CollectBuildJobs(const std::vector<unsigned int>& indices, const std::vector<T>& objects,
+	const std::vector<Circle>& circleColliders, std::vector<BuildJob>& buildJobs) {
+	std::array<std::vector<unsigned int>, 4> childIndices;
+	if (!PartitionNode(indices, objects, circleColliders, childIndices, true)) {
+		return;
+	}
+	for (unsigned int i = 0; i < _quadTreeChildren.size(); i++) {
+		if (_depth + 1 < parallelSplitDepth && childIndices[i].size() >= parallelBuildThreshold) {
+			_quadTreeChildren[i]->CollectBuildJobs(childIndices[i], objects, circleColliders, buildJobs);
+		} else {
+			BuildJob buildJob;
+			buildJob.node = _quadTreeChildren[i].get();
+			buildJob.indices = std::move(childIndices[i]);
+			buildJobs.emplace_back(std::move(buildJob));
 		}
-		if (_quadTreeChildren[0]->Insert(object, circleCollider)) {
-			return true;
-		} else if (_quadTreeChildren[1]->Insert(object, circleCollider)) {
-			return true;
-		} else if (_quadTreeChildren[2]->Insert(object, circleCollider)) {
-			return true;
-		} else if (_quadTreeChildren[3]->Insert(object, circleCollider)) {
-			return true;
+	}
+}
+template<typename T>
+inline unsigned int QuadTree<T>::GetChildIndex(const Circle& circleCollider) const {
+	unsigned int childIndex = 0;
+	if (circleCollider.position.x >= _quadTreeNode.rectangle.position.x) {
+		childIndex += 1;
+	}
+	if (circleCollider.position.y >= _quadTreeNode.rectangle.position.y) {
+		childIndex += 2;
+	}
+	return childIndex;
+}
+template<typename T>
+inline void QuadTree<T>::InsertNode(T& object, Circle& circleCollider) {
+	if (!_divided) {
+		if (_objectsInserted.size() < _capacity || _depth >= maxDepth) {
+			_objectsInserted.emplace_back(object);
+			_circleColliders.emplace_back(circleCollider);
+			return;
 		}
+		Subdevide();
 	}
+	const unsigned int childIndex = GetChildIndex(circleCollider);
+	if (_quadTreeChildren[childIndex]->_quadTreeNode.Contains(circleCollider)) {
+		_quadTreeChildren[childIndex]->InsertNode(object, circleCollider);
+		return;
+	}
+	// Straddles the child boundaries, so it stays in this node.
+	_objectsInserted.emplace_back(object);
+	_circleColliders.emplace_back(circleCollider);
 }
 template<typename T>
 inline std::vector<T> QuadTree<T>::Query(Circle range) {
 	std::vector<T> objectsFound;
-	if (_quadTreeNode.Intersect(range)) {
-		for (unsigned int i = 0; i < _objectsInserted.size(); i++) {
-			if (CircleIntersect(range, _circleColliders[i])) {
-				objectsFound.emplace_back(_objectsInserted[i]);
-			}
+	Query(range, objectsFound);
+	return objectsFound;
+}
+template<typename T>
+inline void QuadTree<T>::Query(Circle range, std::vector<T>& objectsFound) {
+	objectsFound.clear();
+	QueryNode(range, objectsFound);
+	for (unsigned int i = 0; i < _overflowObjects.size(); i++) {
+		if (CircleIntersect(range, _overflowColliders[i])) {
+			objectsFound.emplace_back(_overflowObjects[i]);
 		}
-		if (_divided) {
-			std::vector<T> objectsFoundInChild;
-			if (_quadTreeChildren[0]) {
-				objectsFoundInChild = _quadTreeChildren[0]->Query(range);
-				objectsFound.insert(objectsFound.end(), objectsFoundInChild.begin(), objectsFoundInChild.end());
-			}
-			if (_quadTreeChildren[1]) {
-				objectsFoundInChild = _quadTreeChildren[1]->Query(range);
-				objectsFound.insert(objectsFound.end(), objectsFoundInChild.begin(), objectsFoundInChild.end());
-			}
-			if (_quadTreeChildren[2]) {
-				objectsFoundInChild = _quadTreeChildren[2]->Query(range);
-				objectsFound.insert(objectsFound.end(), objectsFoundInChild.begin(), objectsFoundInChild.end());
+	}
+	_queryCount.fetch_add(1, std::memory_order_relaxed);
+	_queryResultCount.fetch_add(objectsFound.size(), std::memory_order_relaxed);
+}
+template<typename T>
+inline void QuadTree<T>::QueryNearest(Vector2<float> point, unsigned int count, std::vector<BroadphaseHit<T>>& hits) {
+	struct NodeEntry {
+		float squaredDistance;
+		QuadTree<T>* node;
+	};
+	auto isFurther = [](const NodeEntry& entryA, const NodeEntry& entryB) { return entryA.squaredDistance > entryB.squaredDistance; };
+	static thread_local std::vector<NodeEntry> nodeQueue;
+
+	hits.clear();
+	if (count == 0) {
+		return;
+	}
+	for (unsigned int i = 0; i < _overflowObjects.size(); i++) {
+		PushNearestHit(hits, count, _overflowObjects[i],
+			Vector2<float>::squaredDistanceBetweenVectors(_overflowColliders[i].position, point));
+	}
+	nodeQueue.clear();
+	nodeQueue.push_back({ AABBDistanceSquared(_quadTreeNode.looseRectangle, point), this });
+	while (!nodeQueue.empty()) {
+		std::pop_heap(nodeQueue.begin(), nodeQueue.end(), isFurther);
+		const NodeEntry entry = nodeQueue.back();
+		nodeQueue.pop_back();
+		if (hits.size() == count && entry.squaredDistance >= hits.front().distance) {
+			break;
+		}
+		QuadTree<T>* node = entry.node;
+		for (unsigned int i = 0; i < node->_objectsInserted.size(); i++) {
+			PushNearestHit(hits, count, node->_objectsInserted[i],
+				Vector2<float>::squaredDistanceBetweenVectors(node->_circleColliders[i].position, point));
+		}
+		if (!node->_divided) {
+			continue;
+		}
+		for (unsigned int i = 0; i < node->_quadTreeChildren.size(); i++) {
+			QuadTree<T>* child = node->_quadTreeChildren[i].get();
+			const float squaredDistance = AABBDistanceSquared(child->_quadTreeNode.looseRectangle, point);
+			if (hits.size() < count || squaredDistance < hits.front().distance) {
+				nodeQueue.push_back({ squaredDistance, child });
+				std::push_heap(nodeQueue.begin(), nodeQueue.end(), isFurther);
 			}
-			if (_quadTreeChildren[3]) {
-				objectsFoundInChild = _quadTreeChildren[3]->Query(range);
-				objectsFound.insert(objectsFound.end(), objectsFoundInChild.begin(), objectsFoundInChild.end());
+		}
+	}
+	SortNearestHits(hits);
+	_queryCount.fetch_add(1, std::memory_order_relaxed);
+	_queryResultCount.fetch_add(hits.size(), std::memory_order_relaxed);
+}
+template<typename T>
+inline void QuadTree<T>::Raycast(Vector2<float> start, Vector2<float> end, std::vector<BroadphaseHit<T>>& hits) {
+	hits.clear();
+	const float length = Vector2<float>::distanceBetweenVectors(start, end);
+	RaycastNode(start, end, length, hits);
+	float hitFraction = 0.f;
+	for (unsigned int i = 0; i < _overflowObjects.size(); i++) {
+		if (SegmentCircleIntersect(start, end, _overflowColliders[i], hitFraction)) {
+			hits.push_back({ _overflowObjects[i], hitFraction * length });
+		}
+	}
+	std::sort(hits.begin(), hits.end(), [](const BroadphaseHit<T>& hitA, const BroadphaseHit<T>& hitB) {
+		return hitA.distance < hitB.distance;
+	});
+	_queryCount.fetch_add(1, std::memory_order_relaxed);
+	_queryResultCount.fetch_add(hits.size(), std::memory_order_relaxed);
+}
+template<typename T>
+inline void QuadTree<T>::QueryCone(const Cone& cone, std::vector<T>& objectsFound) {
+	objectsFound.clear();
+	QueryConeNode(cone, objectsFound);
+	for (unsigned int i = 0; i < _overflowObjects.size(); i++) {
+		if (ConeCircleIntersect(cone, _overflowColliders[i])) {
+			objectsFound.emplace_back(_overflowObjects[i]);
+		}
+	}
+	_queryCount.fetch_add(1, std::memory_order_relaxed);
+	_queryResultCount.fetch_add(objectsFound.size(), std::memory_order_relaxed);
+}
+template<typename T>
+inline BroadphaseStatistics QuadTree<T>::GetStatistics() {
+	BroadphaseStatistics statistics;
+	CollectStatistics(statistics);
+	statistics.overflowCount = _overflowObjects.size();
+	statistics.queryCount = _queryCount.load(std::memory_order_relaxed);
+	statistics.queryResultCount = _queryResultCount.load(std::memory_order_relaxed);
+	return statistics;
+}
+template<typename T>
+inline void QuadTree<T>::QueryNode(Circle& range, std::vector<T>& objectsFound) {
+	if (!_quadTreeNode.Intersect(range)) {
+		return;
+	}
+	for (unsigned int i = 0; i < _objectsInserted.size(); i++) {
+		if (CircleIntersect(range, _circleColliders[i])) {
+			objectsFound.emplace_back(_objectsInserted[i]);
+		}
+	}
+	if (_divided) {
+		for (unsigned int i = 0; i < _quadTreeChildren.size(); i++) {
+			if (_quadTreeChildren[i]) {
+				_quadTreeChildren[i]->QueryNode(range, objectsFound);
 			}
 		}
 	}
-	return objectsFound;
+}
+template<typename T>
+inline void QuadTree<T>::RaycastNode(Vector2<float> start, Vector2<float> end, float length, std::vector<BroadphaseHit<T>>& hits) {
+	if (!SegmentAABBIntersect(_quadTreeNode.looseRectangle, start, end)) {
+		return;
+	}
+	float hitFraction = 0.f;
+	for (unsigned int i = 0; i < _objectsInserted.size(); i++) {
+		if (SegmentCircleIntersect(start, end, _circleColliders[i], hitFraction)) {
+			hits.push_back({ _objectsInserted[i], hitFraction * length });
+		}
+	}
+	if (_divided) {
+		for (unsigned int i = 0; i < _quadTreeChildren.size(); i++) {
+			_quadTreeChildren[i]->RaycastNode(start, end, length, hits);
+		}
+	}
+}
+template<typename T>
+inline void QuadTree<T>::QueryConeNode(const Cone& cone, std::vector<T>& objectsFound) {
+	if (!ConeAABBIntersect(cone, _quadTreeNode.looseRectangle)) {
+		return;
+	}
+	for (unsigned int i = 0; i < _objectsInserted.size(); i++) {
+		if (ConeCircleIntersect(cone, _circleColliders[i])) {
+			objectsFound.emplace_back(_objectsInserted[i]);
+		}
+	}
+	if (_divided) {
+		for (unsigned int i = 0; i < _quadTreeChildren.size(); i++) {
+			_quadTreeChildren[i]->QueryConeNode(cone, objectsFound);
+		}
+	}
+}
+template<typename T>
+inline void QuadTree<T>::CollectStatistics(BroadphaseStatistics& statistics) {
+	statistics.nodeCount++;
+	statistics.objectCount += _objectsInserted.size();
+	statistics.depthHistogram[std::min<unsigned int>(_depth, statistics.depthHistogram.size() - 1)]++;
+	for (unsigned int i = 0; i < _quadTreeChildren.size(); i++) {
+		if (_quadTreeChildren[i]) {
+			_quadTreeChildren[i]->CollectStatistics(statistics);
+		}
+	}
 }
 template<typename T>
 inline void QuadTree<T>::Clear() {
 	_objectsInserted.clear();
 	_circleColliders.clear();
+	_overflowObjects.clear();
+	_overflowColliders.clear();
+	_queryCount.store(0, std::memory_order_relaxed);
+	_queryResultCount.store(0, std::memory_order_relaxed);
 	Undevide();
 }
 template<typename T>
@@ -147,28 +471,28 @@ inline void QuadTree<T>::Subdevide() {
 			_quadTreeNode.rectangle.position.x - (_quadTreeNode.rectangle.width * 0.25f),
 			_quadTreeNode.rectangle.position.y - (_quadTreeNode.rectangle.height * 0.25f)),
 			_quadTreeNode.rectangle.height * 0.5f, _quadTreeNode.rectangle.width * 0.5f);
-	_quadTreeChildren[0] = std::make_shared<QuadTree<T>>(nw, _capacity);
+	_quadTreeChildren[0] = std::make_shared<QuadTree<T>>(nw, _capacity, _looseness, _depth + 1);
 
 	QuadTreeNode ne;
 	ne.rectangle = AABB::makeFromPositionSize(Vector2<float>(
 		_quadTreeNode.rectangle.position.x + (_quadTreeNode.rectangle.width * 0.25f),
 		_quadTreeNode.rectangle.position.y - (_quadTreeNode.rectangle.height * 0.25f)),
 		_quadTreeNode.rectangle.height * 0.5f, _quadTreeNode.rectangle.width * 0.5f);
-	_quadTreeChildren[1] = std::make_shared<QuadTree<T>>(ne, _capacity);
+	_quadTreeChildren[1] = std::make_shared<QuadTree<T>>(ne, _capacity, _looseness, _depth + 1);
 
 	QuadTreeNode sw;
 	sw.rectangle = AABB::makeFromPositionSize(Vector2<float>(
 		_quadTreeNode.rectangle.position.x - (_quadTreeNode.rectangle.width * 0.25f),
 		_quadTreeNode.rectangle.position.y + (_quadTreeNode.rectangle.height * 0.25f)),
 		_quadTreeNode.rectangle.height * 0.5f, _quadTreeNode.rectangle.width * 0.5f);
-	_quadTreeChildren[2] = std::make_shared<QuadTree<T>>(sw, _capacity);
+	_quadTreeChildren[2] = std::make_shared<QuadTree<T>>(sw, _capacity, _looseness, _depth + 1);
 
 	QuadTreeNode se;
 	se.rectangle = AABB::makeFromPositionSize(Vector2<float>(
 		_quadTreeNode.rectangle.position.x + (_quadTreeNode.rectangle.width * 0.25f),
 		_quadTreeNode.rectangle.position.y + (_quadTreeNode.rectangle.height * 0.25f)),
 		_quadTreeNode.rectangle.height * 0.5f, _quadTreeNode.rectangle.width * 0.5f);
-	_quadTreeChildren[3] = std::make_shared<QuadTree<T>>(se, _capacity);
+	_quadTreeChildren[3] = std::make_shared<QuadTree<T>>(se, _capacity, _looseness, _depth + 1);
 	_divided = true;
 }
 template<typename T>
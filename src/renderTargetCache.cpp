@@ -0,0 +1,55 @@
+#include "renderTargetCache.h"
+
+#include "gameEngine.h"
+
+RenderTargetCache::~RenderTargetCache() {
+	if (_texture) {
+		SDL_DestroyTexture(_texture);
+	}
+}
+
+void RenderTargetCache::Render(const std::function<void()>& draw) {
+	if (!_texture && !_textureFailed) {
+		_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+			(int)windowWidth, (int)windowHeight);
+		_textureFailed = _texture == nullptr;
+		if (_texture) {
+			SDL_SetTextureBlendMode(_texture, SDL_BLENDMODE_NONE);
+		}
+		_valid = false;
+	}
+	if (!_texture) {
+		draw();
+		return;
+	}
+	if (!_valid) {
+		SDL_SetRenderTarget(renderer, _texture);
+		SDL_RenderClear(renderer);
+		draw();
+		SDL_SetRenderTarget(renderer, nullptr);
+		_valid = true;
+		_redrawCount++;
+	}
+	SDL_RenderCopy(renderer, _texture, nullptr, nullptr);
+}
+
+void RenderTargetCache::Invalidate() {
+	_valid = false;
+}
+
+void RenderTargetCache::Reset() {
+	if (_texture) {
+		SDL_DestroyTexture(_texture);
+		_texture = nullptr;
+	}
+	_textureFailed = false;
+	_valid = false;
+}
+
+const bool RenderTargetCache::IsValid() const {
+	return _valid;
+}
+
+const unsigned int RenderTargetCache::GetRedrawCount() const {
+	return _redrawCount;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <SDL2/SDL.h>
+
+#include <functional>
+
+// Keeps a full window frame in a render target texture. Render only runs the draw
+// function when the cache was invalidated, every other call is a single copy of the
+// texture. The cached frame is opaque: it is cleared with the renderer's draw colour
+// before drawing and replaces whatever was drawn before it.
+//
+// If the renderer can't create render targets the draw function runs every call.
+class RenderTargetCache {
+public:
+	RenderTargetCache() {}
+	~RenderTargetCache();
+
+	void Render(const std::function<void()>& draw);
+
+	// The next Render redraws into the texture.
+	void Invalidate();
+	// Also drops the texture, for when the renderer lost its render targets.
+	void Reset();
+
+	const bool IsValid() const;
+	const unsigned int GetRedrawCount() const;
+
+private:
+	SDL_Texture* _texture = nullptr;
+	unsigned int _redrawCount = 0;
+	bool _textureFailed = false;
+	bool _valid = false;
+};
@@ -0,0 +1,173 @@
+#include "rotatedSpriteCache.h"
+
+#include "fastTrig.h"
+#include "gameEngine.h"
+#include "imGuiManager.h"
+
+#include <SDL2/SDL_image.h>
+
+#include <algorithm>
+#include <cmath>
+
+static float MillisecondsSince(Uint64 start) {
+	return (float)(SDL_GetPerformanceCounter() - start) * 1000.f / (float)SDL_GetPerformanceFrequency();
+}
+
+RotatedSpriteCache::~RotatedSpriteCache() {
+	for (unsigned int i = 0; i < _cachedSprites.size(); i++) {
+		if (_cachedSprites[i].texture) {
+			SDL_DestroyTexture(_cachedSprites[i].texture);
+		}
+	}
+}
+
+int RotatedSpriteCache::AddSprite(const char* path) {
+	auto spriteIterator = _spriteIndices.find(path);
+	if (spriteIterator != _spriteIndices.end()) {
+		return spriteIterator->second;
+	}
+	int spriteIndex = -1;
+	SDL_Surface* loadedSurface = IMG_Load(path);
+	SDL_Surface* surface = loadedSurface ? SDL_ConvertSurfaceFormat(loadedSurface, SDL_PIXELFORMAT_ARGB8888, 0) : nullptr;
+	if (surface) {
+		CachedSprite cachedSprite;
+		cachedSprite.sourceWidth = surface->w;
+		cachedSprite.sourceHeight = surface->h;
+		cachedSprite.sourcePixels.resize(surface->w * surface->h);
+		SDL_LockSurface(surface);
+		for (int y = 0; y < surface->h; y++) {
+			const uint32_t* sourceRow = (const uint32_t*)((const uint8_t*)surface->pixels + y * surface->pitch);
+			std::copy(sourceRow, sourceRow + surface->w, &cachedSprite.sourcePixels[y * surface->w]);
+		}
+		SDL_UnlockSurface(surface);
+
+		const Uint64 bakeStart = SDL_GetPerformanceCounter();
+		Bake(cachedSprite);
+		_bakeTime += MillisecondsSince(bakeStart);
+		if (cachedSprite.texture) {
+			spriteIndex = _cachedSprites.size();
+			_cachedSprites.emplace_back(std::move(cachedSprite));
+		}
+		SDL_FreeSurface(surface);
+	}
+	if (loadedSurface) {
+		SDL_FreeSurface(loadedSurface);
+	}
+	_spriteIndices.emplace(path, spriteIndex);
+	return spriteIndex;
+}
+
+// The frame is picked by rounding the orientation to the nearest of the baked angles,
+// and placed so its centre lands where RenderWithOrientation puts the sprite centre.
+bool RotatedSpriteCache::Render(int spriteIndex, Vector2<float> position, float orientation) const {
+	const CachedSprite& cachedSprite = _cachedSprites[spriteIndex];
+	if (!cachedSprite.texture) {
+		return false;
+	}
+	const float angleStep = (float)(2.0 * PI) / _angleCount;
+	int angleIndex = (int)std::floor(orientation / angleStep + 0.5f) % (int)_angleCount;
+	if (angleIndex < 0) {
+		angleIndex += _angleCount;
+	}
+	const int frameSize = cachedSprite.frameSize;
+	SDL_Rect source = { (angleIndex % cachedSprite.columns) * frameSize, (angleIndex / cachedSprite.columns) * frameSize,
+		frameSize, frameSize };
+	SDL_Rect destination = { (int)position.x - frameSize / 2, (int)position.y - frameSize / 2, frameSize, frameSize };
+	SDL_RenderCopy(renderer, cachedSprite.texture, &source, &destination);
+	return true;
+}
+
+void RotatedSpriteCache::SetAngleCount(unsigned int angleCount) {
+	angleCount = std::clamp(angleCount, minAngleCount, maxAngleCount);
+	if (angleCount == _angleCount) {
+		return;
+	}
+	_angleCount = angleCount;
+	_textureBytes = 0;
+	const Uint64 bakeStart = SDL_GetPerformanceCounter();
+	for (unsigned int i = 0; i < _cachedSprites.size(); i++) {
+		Bake(_cachedSprites[i]);
+	}
+	_bakeTime = MillisecondsSince(bakeStart);
+}
+
+const unsigned int RotatedSpriteCache::GetAngleCount() const {
+	return _angleCount;
+}
+
+void RotatedSpriteCache::UpdateImgui() {
+	float angleCount = (float)_angleCount;
+	imGuiHandler->Checkbox("Rotated sprite cache", "Enabled", _enabled);
+	imGuiHandler->SliderFloat("Rotated sprite cache", "Angles", angleCount, (float)minAngleCount, (float)maxAngleCount);
+	SetAngleCount((unsigned int)angleCount);
+	imGuiHandler->ShowFloatValue("Rotated sprite cache", "Max angle error (deg)", 180.f / _angleCount);
+	imGuiHandler->ShowIntValue("Rotated sprite cache", "Sprites", _cachedSprites.size());
+	imGuiHandler->ShowIntValue("Rotated sprite cache", "Texture memory (KB)", _textureBytes / 1024);
+	imGuiHandler->ShowFloatValue("Rotated sprite cache", "Bake (ms)", _bakeTime);
+}
+
+void RotatedSpriteCache::SetEnabled(bool enabled) {
+	_enabled = enabled;
+}
+
+const bool RotatedSpriteCache::IsEnabled() const {
+	return _enabled;
+}
+
+const size_t RotatedSpriteCache::GetTextureBytes() const {
+	return _textureBytes;
+}
+
+const float RotatedSpriteCache::GetBakeTime() const {
+	return _bakeTime;
+}
+
+// Frames are laid out in a square-ish grid, each one rotates its pixel centres back into
+// the source image the same way the software rasterizer does.
+void RotatedSpriteCache::Bake(CachedSprite& cachedSprite) {
+	if (cachedSprite.texture) {
+		SDL_DestroyTexture(cachedSprite.texture);
+		cachedSprite.texture = nullptr;
+	}
+	const int sourceWidth = cachedSprite.sourceWidth;
+	const int sourceHeight = cachedSprite.sourceHeight;
+	const int frameSize = (int)std::ceil(std::sqrt((float)(sourceWidth * sourceWidth + sourceHeight * sourceHeight))) + 1;
+	const int columns = (int)std::ceil(std::sqrt((float)_angleCount));
+	const int rows = (_angleCount + columns - 1) / columns;
+	const int textureWidth = columns * frameSize;
+	const int textureHeight = rows * frameSize;
+	cachedSprite.frameSize = frameSize;
+	cachedSprite.columns = columns;
+
+	_bakePixels.assign(textureWidth * textureHeight, 0);
+	const float halfWidth = (float)(sourceWidth / 2);
+	const float halfHeight = (float)(sourceHeight / 2);
+	const float frameCenter = (float)(frameSize / 2);
+	const float angleStep = (float)(2.0 * PI) / _angleCount;
+	for (unsigned int angleIndex = 0; angleIndex < _angleCount; angleIndex++) {
+		float sine = 0.f;
+		float cosine = 1.f;
+		FastSinCos(angleStep * angleIndex, sine, cosine);
+		uint32_t* frame = &_bakePixels[(angleIndex / columns) * frameSize * textureWidth + (angleIndex % columns) * frameSize];
+		for (int y = 0; y < frameSize; y++) {
+			const float offsetY = y + 0.5f - frameCenter;
+			for (int x = 0; x < frameSize; x++) {
+				const float offsetX = x + 0.5f - frameCenter;
+				const float u = offsetX * cosine + offsetY * sine + halfWidth;
+				const float v = -offsetX * sine + offsetY * cosine + halfHeight;
+				if (u >= 0.f && u < sourceWidth && v >= 0.f && v < sourceHeight) {
+					frame[y * textureWidth + x] = cachedSprite.sourcePixels[(int)v * sourceWidth + (int)u];
+				}
+			}
+		}
+	}
+
+	cachedSprite.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC,
+		textureWidth, textureHeight);
+	if (!cachedSprite.texture) {
+		return;
+	}
+	SDL_UpdateTexture(cachedSprite.texture, nullptr, _bakePixels.data(), textureWidth * sizeof(uint32_t));
+	SDL_SetTextureBlendMode(cachedSprite.texture, SDL_BLENDMODE_BLEND);
+	_textureBytes += (size_t)textureWidth * textureHeight * sizeof(uint32_t);
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "vector2.h"
+
+#include <SDL2/SDL.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Optional replacement for SDL_RenderCopyEx. Every sprite image is baked at a number of
+// evenly spaced angles into one texture per image, and drawing picks the nearest angle
+// and copies it axis aligned. That trades texture memory and an orientation error of
+// up to half an angle step for skipping the rotated copy.
+//
+// Frames are square and big enough for the sprite's diagonal, with the sprite centre
+// placed like Sprite::RenderWithOrientation. Sampling is nearest texel.
+class RotatedSpriteCache {
+public:
+	RotatedSpriteCache() {}
+	~RotatedSpriteCache();
+
+	// Loads and bakes the image once per path, returns its entry or -1 if it could not be loaded.
+	int AddSprite(const char* path);
+
+	// Returns false if the sprite has no baked texture, the caller then draws it rotated.
+	bool Render(int spriteIndex, Vector2<float> position, float orientation) const;
+
+	// Re-bakes every sprite when the count changes.
+	void SetAngleCount(unsigned int angleCount);
+	const unsigned int GetAngleCount() const;
+
+	void UpdateImgui();
+
+	void SetEnabled(bool enabled);
+	const bool IsEnabled() const;
+
+	// Bytes of baked texture memory over all sprites.
+	const size_t GetTextureBytes() const;
+	const float GetBakeTime() const;
+
+	static const unsigned int minAngleCount = 4;
+	static const unsigned int maxAngleCount = 256;
+
+private:
+	struct CachedSprite {
+		std::vector<uint32_t> sourcePixels;
+		int sourceWidth = 0;
+		int sourceHeight = 0;
+
+		SDL_Texture* texture = nullptr;
+		int frameSize = 0;
+		int columns = 0;
+	};
+
+	void Bake(CachedSprite& cachedSprite);
+
+	std::unordered_map<std::string, int> _spriteIndices;
+	std::vector<CachedSprite> _cachedSprites;
+
+	std::vector<uint32_t> _bakePixels;
+
+	unsigned int _angleCount = 64;
+	size_t _textureBytes = 0;
+	float _bakeTime = 0.f;
+
+	bool _enabled = false;
+};
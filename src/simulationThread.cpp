@@ -0,0 +1,171 @@
+#include "simulationThread.h"
+
+#include "enemyManager.h"
+#include "gameEngine.h"
+#include "imGuiManager.h"
+#include "inputQueue.h"
+#include "performanceProfiler.h"
+#include "playerCharacter.h"
+#include "projectileManager.h"
+#include "stateStack.h"
+#include "weaponSystem.h"
+
+#include <algorithm>
+
+SimulationThread::SimulationThread(float fixedDeltaTime) {
+	_fixedDeltaTime = fixedDeltaTime;
+}
+
+SimulationThread::~SimulationThread() {
+	Stop();
+}
+
+void SimulationThread::Start() {
+	if (_thread.joinable()) {
+		return;
+	}
+	gameStateHandler->SetDeferStateChanges(true);
+	_tick.store(frameNumber);
+
+	// Publish the current world first so the first rendered frame never shows a
+	// snapshot left over from an earlier run.
+	PublishSnapshot();
+
+	_tickRateStart = SDL_GetPerformanceCounter();
+	_tickRateStartCount = _ticksSimulated.load();
+	_running.store(true);
+	_thread = std::thread(&SimulationThread::Run, this);
+}
+
+void SimulationThread::Stop() {
+	if (!_thread.joinable()) {
+		return;
+	}
+	_running.store(false);
+	_thread.join();
+
+	// Inputs were applied with simulation ticks, continue counting from there so
+	// none of them is seen as pressed again.
+	frameNumber = std::max(frameNumber, _tick.load());
+	gameStateHandler->SetDeferStateChanges(false);
+	gameStateHandler->ApplyPendingStateChanges();
+}
+
+bool SimulationThread::AcquireSnapshot() {
+	return _snapshotBuffer.AcquireLatest();
+}
+
+void SimulationThread::RecordPresent() {
+	const float latency = (float)(SDL_GetPerformanceCounter() - GetSnapshot().publishTime) * 1000.f /
+		(float)SDL_GetPerformanceFrequency();
+	_averageLatency += (latency - _averageLatency) * 0.05f;
+
+	const Uint64 now = SDL_GetPerformanceCounter();
+	const float elapsed = (float)(now - _tickRateStart) / (float)SDL_GetPerformanceFrequency();
+	if (elapsed >= 0.5f) {
+		_tickRate = (float)(_ticksSimulated.load() - _tickRateStartCount) / elapsed;
+		_tickRateStart = now;
+		_tickRateStartCount = _ticksSimulated.load();
+	}
+}
+
+void SimulationThread::UpdateImgui() {
+	imGuiHandler->Checkbox("Simulation thread", "Pipelined simulation", _enabled);
+	imGuiHandler->ShowIntValue("Simulation thread", "Running", IsRunning() ? 1 : 0);
+	imGuiHandler->ShowFloatValue("Simulation thread", "Ticks per second", _tickRate);
+	imGuiHandler->ShowFloatValue("Simulation thread", "Snapshot age at present (ms)", _averageLatency);
+}
+
+void SimulationThread::SetEnabled(bool enabled) {
+	_enabled = enabled;
+}
+
+void SimulationThread::SetFreeRunning(bool freeRunning) {
+	_freeRunning = freeRunning;
+}
+
+const bool SimulationThread::IsEnabled() const {
+	return _enabled;
+}
+
+const bool SimulationThread::IsRunning() const {
+	return _thread.joinable();
+}
+
+const WorldSnapshot& SimulationThread::GetSnapshot() const {
+	return _snapshotBuffer.GetReadSnapshot();
+}
+
+const float SimulationThread::GetAverageLatency() const {
+	return _averageLatency;
+}
+
+const float SimulationThread::GetFixedDeltaTime() const {
+	return _fixedDeltaTime;
+}
+
+const int SimulationThread::GetTick() const {
+	return _tick.load();
+}
+
+const unsigned int SimulationThread::GetTicksSimulated() const {
+	return _ticksSimulated.load();
+}
+
+void SimulationThread::Run() {
+	frameNumber = _tick.load();
+
+	const Uint64 tickDuration = (Uint64)(_fixedDeltaTime * (float)SDL_GetPerformanceFrequency());
+	Uint64 nextTick = SDL_GetPerformanceCounter();
+
+	// A state change (pause, death) stops the thread, the main thread applies it
+	// and decides whether to start the simulation again.
+	while (_running.load() && !gameStateHandler->HasPendingStateChanges()) {
+		Tick();
+
+		if (_freeRunning) {
+			continue;
+		}
+		nextTick += tickDuration;
+		const Uint64 now = SDL_GetPerformanceCounter();
+		if (now < nextTick) {
+			SDL_Delay((Uint32)((nextTick - now) * 1000 / SDL_GetPerformanceFrequency()));
+		} else {
+			nextTick = now;
+		}
+	}
+}
+
+void SimulationThread::Step() {
+	frameNumber++;
+	deltaTime = _fixedDeltaTime;
+	inputQueue->DispatchEvents();
+
+	gameStateHandler->UpdateState();
+	performanceProfiler->CaptureFrameStatistics();
+	enemyManager->SyncImgui();
+	projectileManager->SyncImgui();
+	weaponSystem->SyncImgui();
+	enemyManager->ClearEnemyQuadTree();
+	projectileManager->ClearProjectileQuadTree();
+}
+
+void SimulationThread::Tick() {
+	Step();
+	_tick.store(frameNumber);
+
+	PublishSnapshot();
+	_ticksSimulated.fetch_add(1);
+}
+
+void SimulationThread::PublishSnapshot() {
+	WorldSnapshot& snapshot = _snapshotBuffer.GetWriteSnapshot();
+	snapshot.Clear();
+	enemyManager->AddRenderItems(snapshot.renderItems);
+	playerCharacter->AddRenderItem(snapshot.renderItems);
+	projectileManager->AddRenderItems(snapshot.renderItems);
+	snapshot.playerHealth = playerCharacter->GetCurrentHealth();
+	snapshot.tick = frameNumber;
+	snapshot.publishTime = SDL_GetPerformanceCounter();
+	_snapshotBuffer.Publish();
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "worldSnapshot.h"
+
+#include <SDL2/SDL.h>
+
+#include <atomic>
+#include <thread>
+
+// Runs GameState updates at a fixed tick rate on a thread of its own. Every tick
+// publishes a WorldSnapshot that the main thread renders while the next tick is
+// simulated, so update and render overlap instead of running back to back.
+// When the thread isn't running the main thread calls Step itself.
+class SimulationThread {
+public:
+	SimulationThread(float fixedDeltaTime);
+	~SimulationThread();
+
+	void Start();
+	void Stop();
+	void Step();
+
+	bool AcquireSnapshot();
+	void RecordPresent();
+	void UpdateImgui();
+
+	void SetEnabled(bool enabled);
+	void SetFreeRunning(bool freeRunning);
+
+	const bool IsEnabled() const;
+	const bool IsRunning() const;
+
+	const WorldSnapshot& GetSnapshot() const;
+
+	const float GetAverageLatency() const;
+	const float GetFixedDeltaTime() const;
+	const int GetTick() const;
+	const unsigned int GetTicksSimulated() const;
+
+private:
+	void Run();
+	void Tick();
+	void PublishSnapshot();
+
+	WorldSnapshotBuffer _snapshotBuffer;
+
+	std::thread _thread;
+
+	std::atomic<bool> _running = false;
+	std::atomic<int> _tick = 0;
+	std::atomic<unsigned int> _ticksSimulated = 0;
+
+	Uint64 _tickRateStart = 0;
+
+	bool _enabled = false;
+	bool _freeRunning = false;
+
+	float _averageLatency = 0.f;
+	float _fixedDeltaTime = 0.f;
+	float _tickRate = 0.f;
+
+	unsigned int _tickRateStartCount = 0;
+};
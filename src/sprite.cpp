@@ -1,9 +1,17 @@
 #include "sprite.h"
 #include "gameEngine.h"
+#include "rotatedSpriteCache.h"
+#include "spriteRasterizer.h"
 
 void Sprite::Load(const char* path) {
 	texture = IMG_LoadTexture(renderer, path);
 	SDL_QueryTexture(texture, NULL, NULL, &w, &h);
+	if (spriteRasterizer) {
+		atlasIndex = spriteRasterizer->AddAtlasSprite(path);
+	}
+	if (rotatedSpriteCache) {
+		rotationIndex = rotatedSpriteCache->AddSprite(path);
+	}
 }
 
 void Sprite::Render(Vector2<float> position) {
@@ -17,6 +25,9 @@ void Sprite::RenderCentered(Vector2<float> position) {
 }
 
 void Sprite::RenderWithOrientation(Vector2<float> position, float orientation) {
+	if (rotationIndex >= 0 && rotatedSpriteCache->IsEnabled() && rotatedSpriteCache->Render(rotationIndex, position, orientation)) {
+		return;
+	}
 	SDL_Rect source = { 0, 0, w, h };
 	SDL_Rect destination = { (int)position.x - w / 2, (int)position.y - h / 2, w, h };
 	SDL_Point center = { w / 2, h / 2 };
@@ -12,4 +12,9 @@ struct Sprite {
 	SDL_Texture* texture;
 	int w;
 	int h;
+
+	// Entry in the software rasterizer atlas, -1 if the sprite only renders through SDL.
+	int atlasIndex = -1;
+	// Entry in the rotated sprite cache, -1 if the sprite is always drawn rotated by SDL.
+	int rotationIndex = -1;
 };
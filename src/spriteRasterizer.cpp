@@ -0,0 +1,300 @@
+#include "spriteRasterizer.h"
+
+#include "fastTrig.h"
+#include "gameEngine.h"
+#include "imGuiManager.h"
+#include "sprite.h"
+#include "workerPool.h"
+
+#include <algorithm>
+#include <cmath>
+
+static float MillisecondsSince(Uint64 start) {
+	return (float)(SDL_GetPerformanceCounter() - start) * 1000.f / (float)SDL_GetPerformanceFrequency();
+}
+
+static uint32_t Premultiply(uint32_t pixel) {
+	const uint32_t alpha = pixel >> 24;
+	const uint32_t red = ((pixel >> 16) & 0xff) * alpha / 255;
+	const uint32_t green = ((pixel >> 8) & 0xff) * alpha / 255;
+	const uint32_t blue = (pixel & 0xff) * alpha / 255;
+	return (alpha << 24) | (red << 16) | (green << 8) | blue;
+}
+
+// Premultiplied source over destination, channel * (255 - alpha) / 255 rounded exactly.
+static uint32_t BlendPixel(uint32_t source, uint32_t destination) {
+	const uint32_t inverseAlpha = 255 - (source >> 24);
+	uint32_t result = 0;
+	for (unsigned int shift = 0; shift < 32; shift += 8) {
+		const uint32_t product = ((destination >> shift) & 0xff) * inverseAlpha + 128;
+		const uint32_t channel = ((product + (product >> 8)) >> 8) + ((source >> shift) & 0xff);
+		result |= std::min<uint32_t>(channel, 255) << shift;
+	}
+	return result;
+}
+
+#ifdef VECTOR2_SIMD
+// Same as BlendPixel for four pixels, two at a time in 16 bit lanes.
+static __m128i BlendPixels(__m128i sources, __m128i destinations) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i full = _mm_set1_epi16(255);
+	const __m128i round = _mm_set1_epi16(128);
+	__m128i blended[2];
+	for (unsigned int half = 0; half < 2; half++) {
+		const __m128i source = half == 0 ? _mm_unpacklo_epi8(sources, zero) : _mm_unpackhi_epi8(sources, zero);
+		const __m128i destination = half == 0 ? _mm_unpacklo_epi8(destinations, zero) : _mm_unpackhi_epi8(destinations, zero);
+		// Copies each pixel's alpha lane over its four channels.
+		const __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(source, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		__m128i product = _mm_add_epi16(_mm_mullo_epi16(destination, _mm_sub_epi16(full, alpha)), round);
+		product = _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+		blended[half] = product;
+	}
+	return _mm_adds_epu8(_mm_packus_epi16(blended[0], blended[1]), sources);
+}
+#endif
+
+SpriteRasterizer::SpriteRasterizer(int width, int height) {
+	_width = width;
+	_height = height;
+	_tilesX = (width + tileSize - 1) / tileSize;
+	_tilesY = (height + tileSize - 1) / tileSize;
+	_tileBins.resize(_tilesX * _tilesY);
+	_framePixels.resize(width * height);
+}
+
+SpriteRasterizer::~SpriteRasterizer() {
+	if (_frameTexture) {
+		SDL_DestroyTexture(_frameTexture);
+	}
+}
+
+// Images are packed on shelves: left to right along the current shelf, and a new shelf
+// starts below the tallest image once the next one doesn't fit.
+int SpriteRasterizer::AddAtlasSprite(const char* path) {
+	auto atlasIterator = _atlasIndices.find(path);
+	if (atlasIterator != _atlasIndices.end()) {
+		return atlasIterator->second;
+	}
+	int atlasIndex = -1;
+	SDL_Surface* loadedSurface = IMG_Load(path);
+	SDL_Surface* surface = loadedSurface ? SDL_ConvertSurfaceFormat(loadedSurface, SDL_PIXELFORMAT_ARGB8888, 0) : nullptr;
+	if (surface && surface->w <= atlasWidth) {
+		if (_shelfX + surface->w > atlasWidth) {
+			_shelfX = 0;
+			_shelfY += _shelfHeight;
+			_shelfHeight = 0;
+		}
+		AtlasEntry atlasEntry;
+		atlasEntry.x = _shelfX;
+		atlasEntry.y = _shelfY;
+		atlasEntry.w = surface->w;
+		atlasEntry.h = surface->h;
+		_shelfX += surface->w;
+		_shelfHeight = std::max(_shelfHeight, surface->h);
+		if (_shelfY + surface->h > _atlasHeight) {
+			_atlasHeight = _shelfY + surface->h;
+			_atlasPixels.resize(atlasWidth * _atlasHeight);
+		}
+
+		SDL_LockSurface(surface);
+		for (int y = 0; y < surface->h; y++) {
+			const uint32_t* sourceRow = (const uint32_t*)((const uint8_t*)surface->pixels + y * surface->pitch);
+			uint32_t* atlasRow = &_atlasPixels[(atlasEntry.y + y) * atlasWidth + atlasEntry.x];
+			for (int x = 0; x < surface->w; x++) {
+				atlasRow[x] = Premultiply(sourceRow[x]);
+			}
+		}
+		SDL_UnlockSurface(surface);
+
+		atlasIndex = _atlasEntries.size();
+		_atlasEntries.emplace_back(atlasEntry);
+	}
+	if (surface) {
+		SDL_FreeSurface(surface);
+	}
+	if (loadedSurface) {
+		SDL_FreeSurface(loadedSurface);
+	}
+	_atlasIndices.emplace(path, atlasIndex);
+	return atlasIndex;
+}
+
+void SpriteRasterizer::Render(const std::vector<RenderItem>& renderItems) {
+	const Uint64 rasterStart = SDL_GetPerformanceCounter();
+	Uint8 red = 0;
+	Uint8 green = 0;
+	Uint8 blue = 0;
+	Uint8 alpha = 0;
+	SDL_GetRenderDrawColor(renderer, &red, &green, &blue, &alpha);
+	_clearPixel = 0xff000000 | (red << 16) | (green << 8) | blue;
+
+	SetupSprites(renderItems);
+	BinSprites();
+	workerPool->Run(_tileBins.size(), [this](unsigned int tileIndex) {
+		RasterizeTile(tileIndex);
+	});
+	_rasterTime = MillisecondsSince(rasterStart);
+
+	const Uint64 uploadStart = SDL_GetPerformanceCounter();
+	if (!_frameTexture) {
+		_frameTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, _width, _height);
+	}
+	SDL_UpdateTexture(_frameTexture, nullptr, _framePixels.data(), _width * sizeof(uint32_t));
+	SDL_RenderCopy(renderer, _frameTexture, nullptr, nullptr);
+	for (unsigned int i = 0; i < _fallbackItems.size(); i++) {
+		_fallbackItems[i]->sprite->RenderWithOrientation(_fallbackItems[i]->position, _fallbackItems[i]->orientation);
+	}
+	_uploadTime = MillisecondsSince(uploadStart);
+}
+
+void SpriteRasterizer::UpdateImgui() {
+	imGuiHandler->Checkbox("Software rasterizer", "Enabled", _enabled);
+	imGuiHandler->ShowFloatValue("Software rasterizer", "Raster (ms)", _rasterTime);
+	imGuiHandler->ShowFloatValue("Software rasterizer", "Upload (ms)", _uploadTime);
+	imGuiHandler->ShowIntValue("Software rasterizer", "Sprites", _rasterSprites.size());
+	imGuiHandler->ShowIntValue("Software rasterizer", "SDL fallback sprites", _fallbackItems.size());
+	imGuiHandler->ShowIntValue("Software rasterizer", "Atlas height", _atlasHeight);
+}
+
+void SpriteRasterizer::SetEnabled(bool enabled) {
+	_enabled = enabled;
+}
+
+const bool SpriteRasterizer::IsEnabled() const {
+	return _enabled;
+}
+
+const float SpriteRasterizer::GetRasterTime() const {
+	return _rasterTime;
+}
+
+const float SpriteRasterizer::GetUploadTime() const {
+	return _uploadTime;
+}
+
+void SpriteRasterizer::SetupSprites(const std::vector<RenderItem>& renderItems) {
+	_rasterSprites.clear();
+	_fallbackItems.clear();
+	for (unsigned int i = 0; i < renderItems.size(); i++) {
+		const Sprite* sprite = renderItems[i].sprite;
+		if (sprite->atlasIndex < 0) {
+			_fallbackItems.emplace_back(&renderItems[i]);
+			continue;
+		}
+		RasterSprite rasterSprite;
+		rasterSprite.atlasEntry = &_atlasEntries[sprite->atlasIndex];
+		const int w = rasterSprite.atlasEntry->w;
+		const int h = rasterSprite.atlasEntry->h;
+		// Sprite::RenderWithOrientation puts the rectangle at (int)position - size / 2 and
+		// rotates around size / 2, which lands the centre on (int)position.
+		rasterSprite.centerX = (float)(int)renderItems[i].position.x;
+		rasterSprite.centerY = (float)(int)renderItems[i].position.y;
+		rasterSprite.halfWidth = (float)(w / 2);
+		rasterSprite.halfHeight = (float)(h / 2);
+		FastSinCos(renderItems[i].orientation, rasterSprite.sine, rasterSprite.cosine);
+
+		const float absCosine = std::fabs(rasterSprite.cosine);
+		const float absSine = std::fabs(rasterSprite.sine);
+		const float extentX = absCosine * w * 0.5f + absSine * h * 0.5f + 1.f;
+		const float extentY = absSine * w * 0.5f + absCosine * h * 0.5f + 1.f;
+		rasterSprite.minX = std::max(0, (int)std::floor(rasterSprite.centerX - extentX));
+		rasterSprite.minY = std::max(0, (int)std::floor(rasterSprite.centerY - extentY));
+		rasterSprite.maxX = std::min(_width, (int)std::ceil(rasterSprite.centerX + extentX));
+		rasterSprite.maxY = std::min(_height, (int)std::ceil(rasterSprite.centerY + extentY));
+		if (rasterSprite.minX < rasterSprite.maxX && rasterSprite.minY < rasterSprite.maxY) {
+			_rasterSprites.emplace_back(rasterSprite);
+		}
+	}
+}
+
+// Every tile gets the indices of the sprites overlapping it in draw order.
+void SpriteRasterizer::BinSprites() {
+	for (unsigned int i = 0; i < _tileBins.size(); i++) {
+		_tileBins[i].clear();
+	}
+	for (unsigned int i = 0; i < _rasterSprites.size(); i++) {
+		const RasterSprite& rasterSprite = _rasterSprites[i];
+		const int tileMaxX = (rasterSprite.maxX - 1) / tileSize;
+		const int tileMaxY = (rasterSprite.maxY - 1) / tileSize;
+		for (int tileY = rasterSprite.minY / tileSize; tileY <= tileMaxY; tileY++) {
+			for (int tileX = rasterSprite.minX / tileSize; tileX <= tileMaxX; tileX++) {
+				_tileBins[tileY * _tilesX + tileX].emplace_back(i);
+			}
+		}
+	}
+}
+
+void SpriteRasterizer::RasterizeTile(unsigned int tileIndex) {
+	const int tileMinX = (tileIndex % _tilesX) * tileSize;
+	const int tileMinY = (tileIndex / _tilesX) * tileSize;
+	const int tileMaxX = std::min(tileMinX + tileSize, _width);
+	const int tileMaxY = std::min(tileMinY + tileSize, _height);
+	for (int y = tileMinY; y < tileMaxY; y++) {
+		std::fill(&_framePixels[y * _width + tileMinX], &_framePixels[y * _width + tileMaxX], _clearPixel);
+	}
+
+	const std::vector<unsigned int>& tileBin = _tileBins[tileIndex];
+	for (unsigned int i = 0; i < tileBin.size(); i++) {
+		const RasterSprite& rasterSprite = _rasterSprites[tileBin[i]];
+		const int minX = std::max(rasterSprite.minX, tileMinX);
+		const int maxX = std::min(rasterSprite.maxX, tileMaxX);
+		const int maxY = std::min(rasterSprite.maxY, tileMaxY);
+		for (int y = std::max(rasterSprite.minY, tileMinY); y < maxY; y++) {
+			RasterizeSpan(rasterSprite, y, minX, maxX, &_framePixels[y * _width]);
+		}
+	}
+}
+
+// Pixel centres are rotated back into the sprite. Both paths compute u and v from the
+// pixel's offset along the span rather than stepping, so they sample the same texels.
+void SpriteRasterizer::RasterizeSpan(const RasterSprite& rasterSprite, int y, int minX, int maxX, uint32_t* row) const {
+	const AtlasEntry& atlasEntry = *rasterSprite.atlasEntry;
+	const float offsetX = minX + 0.5f - rasterSprite.centerX;
+	const float offsetY = y + 0.5f - rasterSprite.centerY;
+	const float startU = offsetX * rasterSprite.cosine + offsetY * rasterSprite.sine + rasterSprite.halfWidth;
+	const float startV = -offsetX * rasterSprite.sine + offsetY * rasterSprite.cosine + rasterSprite.halfHeight;
+	const float stepU = rasterSprite.cosine;
+	const float stepV = -rasterSprite.sine;
+	const uint32_t* atlasOrigin = &_atlasPixels[atlasEntry.y * atlasWidth + atlasEntry.x];
+
+	int x = minX;
+#ifdef VECTOR2_SIMD
+	const __m128 laneOffsets = _mm_set_ps(3.f, 2.f, 1.f, 0.f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 width = _mm_set1_ps((float)atlasEntry.w);
+	const __m128 height = _mm_set1_ps((float)atlasEntry.h);
+	for (; x + 4 <= maxX; x += 4) {
+		const __m128 offsets = _mm_add_ps(_mm_set1_ps((float)(x - minX)), laneOffsets);
+		const __m128 us = _mm_add_ps(_mm_set1_ps(startU), _mm_mul_ps(offsets, _mm_set1_ps(stepU)));
+		const __m128 vs = _mm_add_ps(_mm_set1_ps(startV), _mm_mul_ps(offsets, _mm_set1_ps(stepV)));
+		const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(us, zero), _mm_cmplt_ps(us, width)),
+			_mm_and_ps(_mm_cmpge_ps(vs, zero), _mm_cmplt_ps(vs, height)));
+		const int insideMask = _mm_movemask_ps(inside);
+		if (insideMask == 0) {
+			continue;
+		}
+		// SSE2 has no gather, the texels are fetched one by one.
+		alignas(16) int texelX[4];
+		alignas(16) int texelY[4];
+		_mm_store_si128((__m128i*)texelX, _mm_cvttps_epi32(us));
+		_mm_store_si128((__m128i*)texelY, _mm_cvttps_epi32(vs));
+		alignas(16) uint32_t texels[4];
+		for (unsigned int lane = 0; lane < 4; lane++) {
+			texels[lane] = (insideMask >> lane) & 1 ? atlasOrigin[texelY[lane] * atlasWidth + texelX[lane]] : 0;
+		}
+		const __m128i sources = _mm_load_si128((const __m128i*)texels);
+		_mm_storeu_si128((__m128i*)&row[x], BlendPixels(sources, _mm_loadu_si128((const __m128i*)&row[x])));
+	}
+#endif
+	for (; x < maxX; x++) {
+		const float offset = (float)(x - minX);
+		const float u = startU + offset * stepU;
+		const float v = startV + offset * stepV;
+		if (u >= 0.f && u < atlasEntry.w && v >= 0.f && v < atlasEntry.h) {
+			const uint32_t texel = atlasOrigin[(int)v * atlasWidth + (int)u];
+			if (texel != 0) {
+				row[x] = BlendPixel(texel, row[x]);
+			}
+		}
+	}
+}
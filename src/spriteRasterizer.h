@@ -0,0 +1,96 @@
+#pragma once
+#include "worldSnapshot.h"
+
+#include <SDL2/SDL.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Optional CPU renderer for very large sprite counts. Every sprite image is kept once in
+// a premultiplied ARGB atlas, the render items are binned into screen tiles and the
+// worker threads rasterise the tiles into one frame buffer, which is uploaded to a
+// streaming texture and drawn with a single SDL_RenderCopy.
+//
+// Sampling is nearest texel and the sprite centre is placed the same way as
+// Sprite::RenderWithOrientation, so the output matches the SDL path up to rounding.
+// Items whose sprite is not in the atlas are drawn through SDL after the upload.
+class SpriteRasterizer {
+public:
+	SpriteRasterizer(int width, int height);
+	~SpriteRasterizer();
+
+	// Loads the image once per path, returns its atlas entry or -1 if it could not be loaded.
+	int AddAtlasSprite(const char* path);
+
+	// Clears to the renderer's draw colour and draws the items in order.
+	void Render(const std::vector<RenderItem>& renderItems);
+
+	void UpdateImgui();
+
+	void SetEnabled(bool enabled);
+	const bool IsEnabled() const;
+
+	const float GetRasterTime() const;
+	const float GetUploadTime() const;
+
+	static const int tileSize = 64;
+	static const int atlasWidth = 1024;
+
+private:
+	struct AtlasEntry {
+		int x = 0;
+		int y = 0;
+		int w = 0;
+		int h = 0;
+	};
+
+	// Screen placement of one render item, the bounds are in pixels with max exclusive.
+	struct RasterSprite {
+		float centerX = 0.f;
+		float centerY = 0.f;
+		float cosine = 1.f;
+		float sine = 0.f;
+		float halfWidth = 0.f;
+		float halfHeight = 0.f;
+
+		int minX = 0;
+		int minY = 0;
+		int maxX = 0;
+		int maxY = 0;
+
+		const AtlasEntry* atlasEntry = nullptr;
+	};
+
+	void SetupSprites(const std::vector<RenderItem>& renderItems);
+	void BinSprites();
+	void RasterizeTile(unsigned int tileIndex);
+	void RasterizeSpan(const RasterSprite& rasterSprite, int y, int minX, int maxX, uint32_t* row) const;
+
+	std::unordered_map<std::string, int> _atlasIndices;
+	std::vector<AtlasEntry> _atlasEntries;
+	std::vector<uint32_t> _atlasPixels;
+	int _atlasHeight = 0;
+	int _shelfX = 0;
+	int _shelfY = 0;
+	int _shelfHeight = 0;
+
+	std::vector<RasterSprite> _rasterSprites;
+	std::vector<const RenderItem*> _fallbackItems;
+	std::vector<std::vector<unsigned int>> _tileBins;
+
+	std::vector<uint32_t> _framePixels;
+	SDL_Texture* _frameTexture = nullptr;
+	uint32_t _clearPixel = 0xff000000;
+
+	int _width = 0;
+	int _height = 0;
+	int _tilesX = 0;
+	int _tilesY = 0;
+
+	float _rasterTime = 0.f;
+	float _uploadTime = 0.f;
+
+	bool _enabled = false;
+};
@@ -3,9 +3,13 @@
 #include "dataStructuresAndMethods.h"
 #include "enemyManager.h"
 #include "gameEngine.h"
+#include "imGuiManager.h"
+#include "performanceProfiler.h"
 #include "playerCharacter.h"
 #include "projectileManager.h"
+#include "spriteRasterizer.h"
 #include "timerManager.h"
+#include "weaponSystem.h"
 
 
 Button::Button(const char* spritePath, int height, int width, Vector2<float> position) {
@@ -50,22 +54,30 @@ GameStateHandler::GameStateHandler() {
 GameStateHandler::~GameStateHandler() {}
 
 void GameStateHandler::AddState(std::shared_ptr<State> state) {
-	_states.emplace_back(state);
+	ChangeState([this, state]() {
+		_states.emplace_back(state);
+	});
 }
 
 void GameStateHandler::BackToFirstState() {
-	while (_states.size() > 1) {
-		_states.pop_back();
-	}
+	ChangeState([this]() {
+		while (_states.size() > 1) {
+			_states.pop_back();
+		}
+	});
 }
 
 void GameStateHandler::ReplaceCurrentState(std::shared_ptr<State> state) {
-	_states.pop_back();
-	_states.emplace_back(state);
+	ChangeState([this, state]() {
+		_states.pop_back();
+		_states.emplace_back(state);
+	});
 }
 
 void GameStateHandler::RemoveCurrentState() {
-	_states.pop_back();
+	ChangeState([this]() {
+		_states.pop_back();
+	});
 }
 
 void GameStateHandler::UpdateState() {
@@ -73,6 +85,12 @@ void GameStateHandler::UpdateState() {
 }
 
 void GameStateHandler::RenderState() {
+	if (_renderCachingEnabled && _states.back()->IsStatic()) {
+		_renderCache.Render([this]() {
+			_states.back()->Render();
+		});
+		return;
+	}
 	_states.back()->Render();
 }
 
@@ -80,21 +98,109 @@ void GameStateHandler::RenderStateText() {
 	_states.back()->RenderText();
 }
 
+void GameStateHandler::SetDeferStateChanges(bool deferStateChanges) {
+	_deferStateChanges = deferStateChanges;
+}
+
+void GameStateHandler::ApplyPendingStateChanges() {
+	for (unsigned int i = 0; i < _pendingStateChanges.size(); i++) {
+		_pendingStateChanges[i]();
+	}
+	_pendingStateChanges.clear();
+	_hasPendingStateChanges.store(false);
+}
+
+const bool GameStateHandler::HasPendingStateChanges() const {
+	return _hasPendingStateChanges.load();
+}
+
+const bool GameStateHandler::IsGameStateActive() const {
+	return !_states.empty() && std::dynamic_pointer_cast<GameState>(_states.back()) != nullptr;
+}
+
+void GameStateHandler::SetRenderCachingEnabled(bool renderCachingEnabled) {
+	_renderCachingEnabled = renderCachingEnabled;
+	_renderCache.Invalidate();
+}
+
+const bool GameStateHandler::IsRenderCachingEnabled() const {
+	return _renderCachingEnabled;
+}
+
+void GameStateHandler::ResetRenderCache() {
+	_renderCache.Reset();
+}
+
+void GameStateHandler::UpdateImgui() {
+	bool renderCachingEnabled = _renderCachingEnabled;
+	imGuiHandler->Checkbox("Render cache", "Cache static states", renderCachingEnabled);
+	if (renderCachingEnabled != _renderCachingEnabled) {
+		SetRenderCachingEnabled(renderCachingEnabled);
+	}
+	imGuiHandler->ShowIntValue("Render cache", "Redraws", _renderCache.GetRedrawCount());
+}
+
+// Every change to the stack also invalidates the cached frame, so entering pause
+// captures the frozen world once and the menus redraw once per visit.
+void GameStateHandler::ChangeState(std::function<void()> stateChange) {
+	stateChange = [this, stateChange]() {
+		stateChange();
+		_renderCache.Invalidate();
+	};
+	if (_deferStateChanges) {
+		_pendingStateChanges.emplace_back(stateChange);
+		_hasPendingStateChanges.store(true);
+		return;
+	}
+	stateChange();
+}
+
 GameState::GameState() {
 	playerCharacter->Respawn();
 }
 
 void GameState::Update() {
-	enemyManager->UpdateQuadTree();
-	projectileManager->UpdateQuadTree();
-
-	enemyManager->Update();
-	projectileManager->Update();
-	playerCharacter->Update();
-	timerManager->Update();
+	{
+		ProfilerScope profilerScope(ProfilerPhase::SpatialSort);
+		enemyManager->UpdateSpatialOrder();
+		projectileManager->UpdateSpatialOrder();
+	}
+	{
+		ProfilerScope profilerScope(ProfilerPhase::QuadTreeBuild);
+		enemyManager->UpdateQuadTree();
+		projectileManager->UpdateQuadTree();
+	}
+	{
+		ProfilerScope profilerScope(ProfilerPhase::EnemyUpdate);
+		enemyManager->Update();
+	}
+	{
+		ProfilerScope profilerScope(ProfilerPhase::EnemyAttack);
+		weaponSystem->ResolveAttacks();
+	}
+	{
+		ProfilerScope profilerScope(ProfilerPhase::ProjectileUpdate);
+		projectileManager->Update();
+	}
+	{
+		ProfilerScope profilerScope(ProfilerPhase::PlayerUpdate);
+		playerCharacter->Update();
+	}
+	{
+		ProfilerScope profilerScope(ProfilerPhase::TimerUpdate);
+		timerManager->Update();
+	}
 }
 
 void GameState::Render() {
+	if (spriteRasterizer->IsEnabled()) {
+		_renderItems.clear();
+		enemyManager->AddRenderItems(_renderItems);
+		playerCharacter->AddRenderItem(_renderItems);
+		projectileManager->AddRenderItems(_renderItems);
+		spriteRasterizer->Render(_renderItems);
+		return;
+	}
 	enemyManager->Render();
 	playerCharacter->Render();
 	projectileManager->Render();
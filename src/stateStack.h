@@ -1,8 +1,12 @@
 #pragma once
 #include "collision.h"
+#include "renderTargetCache.h"
 #include "sprite.h"
+#include "worldSnapshot.h"
 
 #include <array>
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <stack>
 #include <unordered_map>
@@ -42,6 +46,10 @@ public:
 	virtual void Update() = 0;
 	virtual void Render() = 0;
 	virtual void RenderText() = 0;
+
+	// Static states draw the same frame until the state stack changes, so the
+	// handler draws them once into a render target and copies that afterwards.
+	virtual bool IsStatic() const { return false; }
 };
 
 class GameStateHandler {
@@ -58,8 +66,32 @@ public:
 	void RenderState();
 	void RenderStateText();
 
+	// While the simulation runs on its own thread state changes are queued here
+	// and applied by the main thread once the simulation thread has stopped.
+	void SetDeferStateChanges(bool deferStateChanges);
+	void ApplyPendingStateChanges();
+	const bool HasPendingStateChanges() const;
+
+	const bool IsGameStateActive() const;
+
+	void SetRenderCachingEnabled(bool renderCachingEnabled);
+	const bool IsRenderCachingEnabled() const;
+	// Drops the cached frame's texture, for when the renderer lost its render targets.
+	void ResetRenderCache();
+
+	void UpdateImgui();
+
 private:
+	void ChangeState(std::function<void()> stateChange);
+
 	std::vector<std::shared_ptr<State>> _states;
+	std::vector<std::function<void()>> _pendingStateChanges;
+
+	RenderTargetCache _renderCache;
+
+	std::atomic<bool> _hasPendingStateChanges = false;
+	bool _deferStateChanges = false;
+	bool _renderCachingEnabled = true;
 
 };
 
@@ -71,6 +103,7 @@ public:
 	void Update() override;
 	void Render() override;
 	void RenderText() override;
+	bool IsStatic() const override { return true; }
 };
 class GameState : public State {
 public:
@@ -81,6 +114,8 @@ public:
 	void Render() override;
 	void RenderText() override;
 
+private:
+	std::vector<RenderItem> _renderItems;
 };
 class MenuState : public State {
 public:
@@ -90,6 +125,7 @@ public:
 	void Update() override;
 	void Render() override;
 	void RenderText() override;
+	bool IsStatic() const override { return true; }
 };
 class PauseState : public State {
 public:
@@ -99,4 +135,5 @@ public:
 	void Update() override;
 	void Render() override;
 	void RenderText() override;
+	bool IsStatic() const override { return true; }
 };
@@ -11,11 +11,12 @@ SteeringOutput SeparationBehaviour::Steering(EnemyBase* enemyData) {
 	_distance = 0;
 	_strength = 0.f;
 
-	for (unsigned int i = 0; i < enemyData->GetQueriedEnemies().size(); i++) {
-		if (enemyData->GetObjectID() == enemyData->GetQueriedEnemies()[i]->GetObjectID()) {
+	const std::vector<std::shared_ptr<EnemyBase>>& queriedEnemies = enemyData->GetQueriedEnemies();
+	for (unsigned int i = 0; i < queriedEnemies.size(); i++) {
+		if (enemyData->GetObjectID() == queriedEnemies[i]->GetObjectID()) {
 			continue;
 		}
-		_targetPosition = enemyData->GetQueriedEnemies()[i]->GetPosition();
+		_targetPosition = queriedEnemies[i]->GetPosition();
 		_direction = _targetPosition - enemyData->GetPosition();
 		_distance = _direction.absolute();
 		if (_distance < _separationThreshold) {
@@ -22,3 +22,7 @@ std::shared_ptr<Timer> TimerManager::CreateTimer(float timeInSeconds) {
 	_timers.emplace_back(timer);
 	return timer;
 }
+
+const unsigned int TimerManager::GetTimerCount() const {
+	return _timers.size();
+}
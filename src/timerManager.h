@@ -15,6 +15,8 @@ public:
 	
 	std::shared_ptr<Timer> CreateTimer(float timeInSeconds);
 
+	const unsigned int GetTimerCount() const;
+
 private:
 	std::vector<std::shared_ptr<Timer>> _timers;
 };
\ No newline at end of file
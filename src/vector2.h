@@ -1,44 +1,54 @@
-
 #ifndef _Vector2_hpp_
 #define _Vector2_hpp_
 
+#include <cmath>
 #include <iostream>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VECTOR2_SIMD 1
+#include <emmintrin.h>
+#endif
+
 template<typename T>
 class Vector2{
 public:
 	//constructors
-	Vector2(T ix, T iy);
-	Vector2(T ia);
-	Vector2();
+	constexpr Vector2(T ix, T iy): x(ix), y(iy){}
+	constexpr Vector2(T ia): x(ia), y(ia){}
+	constexpr Vector2(): x(0), y(0){}
 
 	//variables
 	T x,y;
 
 	//operators
-	Vector2 operator+(const Vector2 &right) const;
-	Vector2 operator-(const Vector2 &right) const;
-	Vector2 operator*(const Vector2 &right) const;
-	Vector2 operator/(const Vector2 &right) const;
-	Vector2& operator+=(const Vector2 &right);
-	Vector2& operator-=(const Vector2 &right);
-	Vector2& operator*=(const Vector2 &right);
-	Vector2& operator/=(const Vector2 &right);
+	constexpr Vector2 operator+(const Vector2 &right) const;
+	constexpr Vector2 operator-(const Vector2 &right) const;
+	constexpr Vector2 operator*(const Vector2 &right) const;
+	constexpr Vector2 operator/(const Vector2 &right) const;
+	constexpr Vector2& operator+=(const Vector2 &right);
+	constexpr Vector2& operator-=(const Vector2 &right);
+	constexpr Vector2& operator*=(const Vector2 &right);
+	constexpr Vector2& operator/=(const Vector2 &right);
 
 	//functions
 	/**
 	 * @brief Change the vector length to exactly one
 	 */
 	void normalize();
+	/**
+	 * @brief Change the vector length to one using a reciprocal square root estimate.
+	 * @details Accurate to about 1e-6 relative error, meant for directions in hot loops.
+	 */
+	void fastNormalize();
 	/**
 	 * @brief Rotate the vector clockwize in the z direction
-	 * 
+	 *
 	 * @param rotation Rotation angle in radians.
 	 */
 	void rotate(T rotation);
 	/**
 	 * @brief Rotate the vector clockwize in the z direction
-	 * 
+	 *
 	 * @param rotation Rotation angle in radians.
 	 */
 	Vector2 rotated(T rotation) const;
@@ -48,28 +58,175 @@ public:
 	 * @return this vector normilized
 	 */
 	Vector2 normalized() const;
+	/**
+	 * @brief Return this vector normalized with a reciprocal square root estimate.
+	 * @return this vector normalized, or a zero vector if this vector has no length
+	 */
+	Vector2 fastNormalized() const;
 	/**
 	 * @brief Calcultes the length of the vector and returns it.
 	 * @details [long description]
 	 * @return The lenght of this vector
 	 */
 	T absolute() const;
-	
+	/**
+	 * @brief Calculates the squared length of the vector, no square root needed.
+	 * @return The squared length of this vector
+	 */
+	constexpr T squaredAbsolute() const;
+
 	static T distanceBetweenVectors(Vector2 vectorA, Vector2 vectorB);
-		
+	static constexpr T squaredDistanceBetweenVectors(Vector2 vectorA, Vector2 vectorB);
+	/**
+	 * @brief Check if two points are within a distance of each other.
+	 * @details Compares squared distances so no square root is taken.
+	 */
+	static constexpr bool isWithinDistance(Vector2 vectorA, Vector2 vectorB, T distance);
+
 	/**
 	 * @brief Calculate the dot product of two vetors.
 	 * @details The dot product is the product of the vector in the
 	 * same length.
-	 * 
+	 *
 	 * @param left Left hand side of the dot operator.
 	 * @param right Right hand side of the dot operator.
-	 * 
+	 *
 	 * @return Vector result of the dot operation.
 	 */
-	static T dotProduct(const Vector2 &left, const Vector2 &right);
+	static constexpr T dotProduct(const Vector2 &left, const Vector2 &right);
 };
 
+/**
+ * @brief Reciprocal square root, uses the SSE estimate refined with one Newton step when available.
+ */
+inline float FastReciprocalSqrt(float value){
+#ifdef VECTOR2_SIMD
+	const float estimate = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(value)));
+	return estimate * (1.5f - 0.5f * value * estimate * estimate);
+#else
+	return 1.f / std::sqrt(value);
+#endif
+}
+
+template<typename T>
+constexpr Vector2<T> Vector2<T>::operator+(const Vector2<T> &right) const{
+	return Vector2<T>(x + right.x, y + right.y);
+}
+template<typename T>
+constexpr Vector2<T> Vector2<T>::operator-(const Vector2<T> &right) const{
+	return Vector2<T>(x - right.x, y - right.y);
+}
+template<typename T>
+constexpr Vector2<T> Vector2<T>::operator*(const Vector2<T> &right) const{
+	return Vector2<T>(x * right.x, y * right.y);
+}
+template<typename T>
+constexpr Vector2<T> Vector2<T>::operator/(const Vector2<T> &right) const{
+	Vector2<T> temp(*this);
+	temp /= right;
+	return temp;
+}
+template<typename T>
+constexpr Vector2<T>& Vector2<T>::operator+=(const Vector2<T> &right){
+	x += right.x;
+	y += right.y;
+	return *this;
+}
+template<typename T>
+constexpr Vector2<T>& Vector2<T>::operator-=(const Vector2<T> &right){
+	x -= right.x;
+	y -= right.y;
+	return *this;
+}
+template<typename T>
+constexpr Vector2<T>& Vector2<T>::operator*=(const Vector2<T> &right){
+	x *= right.x;
+	y *= right.y;
+	return *this;
+}
+template<typename T>
+constexpr Vector2<T>& Vector2<T>::operator/=(const Vector2<T> &right){
+	if(right.x != 0 && right.y != 0){
+		x /= right.x;
+		y /= right.y;
+	}
+	return *this;
+}
+template<typename T>
+inline void Vector2<T>::normalize(){
+	if(x != 0 || y != 0){
+		T lenght = std::sqrt((x * x) + (y * y));
+		x /= lenght;
+		y /= lenght;
+	}
+}
+template<typename T>
+inline void Vector2<T>::fastNormalize(){
+	*this = fastNormalized();
+}
+template<typename T>
+inline void Vector2<T>::rotate(T rotation){
+	T x_1 = x;
+	x = (x * std::cos(rotation)) - (y * std::sin(rotation));
+	y = (x_1 * std::sin(rotation)) + (y * std::cos(rotation));
+}
+template<typename T>
+inline Vector2<T> Vector2<T>::rotated(T rotation) const{
+	return Vector2(
+		(x * std::cos(rotation)) - (y * std::sin(rotation)),
+		(x * std::sin(rotation)) + (y * std::cos(rotation))
+	);
+}
+template<typename T>
+inline Vector2<T> Vector2<T>::normalized() const{
+	if(x != 0 || y != 0){
+		T lenght = std::sqrt((x * x) + (y * y));
+		return Vector2<T>(
+			x / lenght,
+			y / lenght);
+	}
+	else{
+		return Vector2<T>(0, 0);
+	}
+}
+template<typename T>
+inline Vector2<T> Vector2<T>::fastNormalized() const{
+	const T squaredLength = squaredAbsolute();
+	if(squaredLength > 0){
+		const T inverseLength = (T)FastReciprocalSqrt((float)squaredLength);
+		return Vector2<T>(x * inverseLength, y * inverseLength);
+	}
+	return Vector2<T>(0, 0);
+}
+template<typename T>
+inline T Vector2<T>::absolute() const{
+	return std::sqrt((x * x) + (y * y));
+}
+template<typename T>
+constexpr T Vector2<T>::squaredAbsolute() const{
+	return (x * x) + (y * y);
+}
+template<typename T>
+inline T Vector2<T>::distanceBetweenVectors(Vector2 vectorA, Vector2 vectorB) {
+	return std::sqrt(squaredDistanceBetweenVectors(vectorA, vectorB));
+}
+template<typename T>
+constexpr T Vector2<T>::squaredDistanceBetweenVectors(Vector2 vectorA, Vector2 vectorB) {
+	return ((vectorA.x - vectorB.x) * (vectorA.x - vectorB.x)) +
+		((vectorA.y - vectorB.y) * (vectorA.y - vectorB.y));
+}
+template<typename T>
+constexpr bool Vector2<T>::isWithinDistance(Vector2 vectorA, Vector2 vectorB, T distance) {
+	return squaredDistanceBetweenVectors(vectorA, vectorB) <= distance * distance;
+}
+template<typename T>
+constexpr T Vector2<T>::dotProduct(const Vector2<T> &left, const Vector2<T> &right){
+	return left.x * right.x + left.y * right.y;
+}
+
 template<typename T>
-std::ostream& operator<<(std::ostream& os, const Vector2<T>& vector2);
+std::ostream& operator<<(std::ostream& os, const Vector2<T>& vector2){
+    os << '{' << vector2.x << ',' << vector2.y << '}';
+    return os;
+}
 #endif //_Vector2_hpp_
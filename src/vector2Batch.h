@@ -0,0 +1,82 @@
+#pragma once
+#include "vector2.h"
+
+#include <cstddef>
+#include <span>
+
+// Batch operations over contiguous spans of Vector2<float>. The spans are read as
+// interleaved x/y floats, so the SSE paths handle two vectors per instruction and the
+// remaining vector falls back to the scalar code. Every span passed to one call must
+// have the same size, and results may alias the inputs.
+static_assert(sizeof(Vector2<float>) == sizeof(float) * 2, "Vector2<float> must be two packed floats");
+
+inline void AddVectors(std::span<const Vector2<float>> vectorsA, std::span<const Vector2<float>> vectorsB,
+	std::span<Vector2<float>> result) {
+	const size_t count = result.size();
+	size_t i = 0;
+#ifdef VECTOR2_SIMD
+	for (; i + 2 <= count; i += 2) {
+		const __m128 a = _mm_loadu_ps(&vectorsA[i].x);
+		const __m128 b = _mm_loadu_ps(&vectorsB[i].x);
+		_mm_storeu_ps(&result[i].x, _mm_add_ps(a, b));
+	}
+#endif
+	for (; i < count; i++) {
+		result[i] = vectorsA[i] + vectorsB[i];
+	}
+}
+
+inline void ScaleVectors(std::span<const Vector2<float>> vectors, float scale, std::span<Vector2<float>> result) {
+	const size_t count = result.size();
+	size_t i = 0;
+#ifdef VECTOR2_SIMD
+	const __m128 scales = _mm_set1_ps(scale);
+	for (; i + 2 <= count; i += 2) {
+		_mm_storeu_ps(&result[i].x, _mm_mul_ps(_mm_loadu_ps(&vectors[i].x), scales));
+	}
+#endif
+	for (; i < count; i++) {
+		result[i] = Vector2<float>(vectors[i].x * scale, vectors[i].y * scale);
+	}
+}
+
+// positions[i] += directions[i] * scale, the usual movement step.
+inline void MultiplyAddVectors(std::span<Vector2<float>> positions, std::span<const Vector2<float>> directions,
+	float scale) {
+	const size_t count = positions.size();
+	size_t i = 0;
+#ifdef VECTOR2_SIMD
+	const __m128 scales = _mm_set1_ps(scale);
+	for (; i + 2 <= count; i += 2) {
+		const __m128 step = _mm_mul_ps(_mm_loadu_ps(&directions[i].x), scales);
+		_mm_storeu_ps(&positions[i].x, _mm_add_ps(_mm_loadu_ps(&positions[i].x), step));
+	}
+#endif
+	for (; i < count; i++) {
+		positions[i] += Vector2<float>(directions[i].x * scale, directions[i].y * scale);
+	}
+}
+
+// Same precision as Vector2::fastNormalized, zero length vectors stay zero.
+inline void NormalizeVectors(std::span<Vector2<float>> vectors) {
+	const size_t count = vectors.size();
+	size_t i = 0;
+#ifdef VECTOR2_SIMD
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 threeHalves = _mm_set1_ps(1.5f);
+	for (; i + 2 <= count; i += 2) {
+		const __m128 vector = _mm_loadu_ps(&vectors[i].x);
+		const __m128 squared = _mm_mul_ps(vector, vector);
+		// Adds x*x and y*y within each vector, giving the squared length in both lanes.
+		const __m128 squaredLength = _mm_add_ps(squared, _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(2, 3, 0, 1)));
+		__m128 inverseLength = _mm_rsqrt_ps(squaredLength);
+		inverseLength = _mm_mul_ps(inverseLength, _mm_sub_ps(threeHalves,
+			_mm_mul_ps(_mm_mul_ps(half, squaredLength), _mm_mul_ps(inverseLength, inverseLength))));
+		inverseLength = _mm_and_ps(inverseLength, _mm_cmpgt_ps(squaredLength, _mm_setzero_ps()));
+		_mm_storeu_ps(&vectors[i].x, _mm_mul_ps(vector, inverseLength));
+	}
+#endif
+	for (; i < count; i++) {
+		vectors[i] = vectors[i].fastNormalized();
+	}
+}
@@ -0,0 +1,172 @@
+#include "weaponSystem.h"
+
+#include "enemyBase.h"
+#include "enemyManager.h"
+#include "gameEngine.h"
+#include "imGuiManager.h"
+#include "playerCharacter.h"
+#include "projectileManager.h"
+#include "sprite.h"
+#include "vector2Batch.h"
+
+#include <algorithm>
+
+static const std::array<WeaponData, (unsigned int)WeaponType::Count> weaponTable = { {
+	{ WeaponAttack::Melee, 1, 15.f, 1.f, nullptr },
+	{ WeaponAttack::Melee, 2, 25.f, 1.f, "res/sprites/Sword.png" },
+	{ WeaponAttack::Ranged, 1, 300.f, 1.5f, "res/sprites/WizardHat.png" },
+} };
+
+const WeaponData& GetWeaponData(WeaponType weaponType) {
+	return weaponTable[(unsigned int)weaponType];
+}
+
+WeaponSystem::WeaponSystem() {
+	for (unsigned int i = 0; i < _sprites.size(); i++) {
+		if (weaponTable[i].spritePath) {
+			_sprites[i] = std::make_shared<Sprite>();
+			_sprites[i]->Load(weaponTable[i].spritePath);
+		}
+	}
+
+	// One band per distinct weapon range, shortest first.
+	std::array<float, rangeBandCount> ranges = {};
+	for (unsigned int i = 0; i < weaponTable.size(); i++) {
+		ranges[i] = weaponTable[i].range;
+	}
+	std::sort(ranges.begin(), ranges.end());
+	_usedBandCount = std::unique(ranges.begin(), ranges.end()) - ranges.begin();
+	for (unsigned int i = 0; i < _usedBandCount; i++) {
+		_bandRanges[i] = ranges[i];
+		_bandLabels[i] = "Within " + std::to_string((int)ranges[i]) + " px";
+	}
+	for (unsigned int i = 0; i < weaponTable.size(); i++) {
+		_weaponBands[i] = std::find(ranges.begin(), ranges.begin() + _usedBandCount, weaponTable[i].range) - ranges.begin();
+	}
+}
+
+void WeaponSystem::ResolveAttacks() {
+	GatherAttackers();
+	for (unsigned int i = 0; i < weaponTable.size(); i++) {
+		if (weaponTable[i].attack == WeaponAttack::Melee) {
+			ResolveMeleeAttacks((WeaponType)i);
+		} else {
+			ResolveRangedAttacks((WeaponType)i);
+		}
+	}
+}
+
+unsigned int WeaponSystem::GatherAttackers() {
+	for (unsigned int i = 0; i < _rangeBands.size(); i++) {
+		_rangeBands[i].clear();
+	}
+	const Vector2<float> playerPosition = playerCharacter->GetPosition();
+	const float maxRange = _bandRanges[_usedBandCount - 1];
+
+	const std::vector<std::shared_ptr<EnemyBase>>& broadphaseEnemies = enemyManager->GetBroadphaseEnemies();
+	_playerQueryUsed = _settings.playerQueryEnabled && (!_settings.adaptiveQueryEnabled || _inRangeFraction <= _settings.sparseFraction);
+	if (_playerQueryUsed) {
+		enemyManager->GetEnemyBroadphase()->Query(Circle{ maxRange + _queryMargin, playerPosition }, _queriedEnemies);
+	}
+	const std::vector<std::shared_ptr<EnemyBase>>& attackers = _playerQueryUsed ? _queriedEnemies : broadphaseEnemies;
+
+	for (unsigned int i = 0; i < attackers.size(); i++) {
+		const float squaredDistance = Vector2<float>::squaredDistanceBetweenVectors(attackers[i]->GetPosition(), playerPosition);
+		for (unsigned int b = 0; b < _usedBandCount; b++) {
+			if (squaredDistance <= _bandRanges[b] * _bandRanges[b]) {
+				_rangeBands[b].emplace_back(attackers[i].get());
+				break;
+			}
+		}
+	}
+	unsigned int inRangeCount = 0;
+	for (unsigned int b = 0; b < _usedBandCount; b++) {
+		inRangeCount += _rangeBands[b].size();
+	}
+	_inRangeFraction = broadphaseEnemies.empty() ? 0.f : (float)inRangeCount / broadphaseEnemies.size();
+	_attackersTested = attackers.size();
+	return _attackersTested;
+}
+
+void WeaponSystem::Render(WeaponType weaponType, Vector2<float> position, float orientation) {
+	_sprites[(unsigned int)weaponType]->RenderWithOrientation(position, orientation);
+}
+
+void WeaponSystem::AddRenderItem(std::vector<RenderItem>& renderItems, WeaponType weaponType, Vector2<float> position, float orientation) const {
+	renderItems.push_back({ _sprites[(unsigned int)weaponType].get(), position, orientation });
+}
+
+void WeaponSystem::UpdateImgui() {
+	std::lock_guard<std::mutex> lock(_imguiMutex);
+	imGuiHandler->Checkbox("Enemy attacks", "Query around player", _imguiSettings.playerQueryEnabled);
+	imGuiHandler->Checkbox("Enemy attacks", "Only when sparse", _imguiSettings.adaptiveQueryEnabled);
+	imGuiHandler->SliderFloat("Enemy attacks", "Sparse fraction", _imguiSettings.sparseFraction, 0.f, 1.f);
+	imGuiHandler->ShowText("Enemy attacks", _imguiStatistics.playerQueryUsed ? "Using player query" : "Testing all enemies");
+	imGuiHandler->ShowFloatValue("Enemy attacks", "In range fraction", _imguiStatistics.inRangeFraction);
+	imGuiHandler->ShowIntValue("Enemy attacks", "Enemies tested", _imguiStatistics.attackersTested);
+	for (unsigned int i = 0; i < _usedBandCount; i++) {
+		imGuiHandler->ShowIntValue("Enemy attacks", _bandLabels[i].c_str(), _imguiStatistics.bandSizes[i]);
+	}
+}
+
+void WeaponSystem::SyncImgui() {
+	std::lock_guard<std::mutex> lock(_imguiMutex);
+	_settings = _imguiSettings;
+	for (unsigned int i = 0; i < _rangeBands.size(); i++) {
+		_imguiStatistics.bandSizes[i] = _rangeBands[i].size();
+	}
+	_imguiStatistics.inRangeFraction = _inRangeFraction;
+	_imguiStatistics.attackersTested = _attackersTested;
+	_imguiStatistics.playerQueryUsed = _playerQueryUsed;
+}
+
+void WeaponSystem::SetPlayerQueryEnabled(bool playerQueryEnabled, bool adaptive) {
+	std::lock_guard<std::mutex> lock(_imguiMutex);
+	_settings.playerQueryEnabled = playerQueryEnabled;
+	_settings.adaptiveQueryEnabled = adaptive;
+	_imguiSettings.playerQueryEnabled = playerQueryEnabled;
+	_imguiSettings.adaptiveQueryEnabled = adaptive;
+}
+
+// Every hit of the pass is summed so the player takes the damage in one call.
+void WeaponSystem::ResolveMeleeAttacks(WeaponType weaponType) {
+	const WeaponData& weaponData = GetWeaponData(weaponType);
+	unsigned int damageAmount = 0;
+	for (unsigned int b = 0; b <= _weaponBands[(unsigned int)weaponType]; b++) {
+		for (unsigned int i = 0; i < _rangeBands[b].size(); i++) {
+			EnemyBase* enemy = _rangeBands[b][i];
+			if (enemy->GetWeaponType() == weaponType && enemy->IsWeaponReady()) {
+				damageAmount += weaponData.damage;
+				enemy->ResetWeaponCooldown();
+			}
+		}
+	}
+	if (damageAmount > 0) {
+		playerCharacter->TakeDamage(damageAmount);
+	}
+}
+
+void WeaponSystem::ResolveRangedAttacks(WeaponType weaponType) {
+	const WeaponData& weaponData = GetWeaponData(weaponType);
+	const Vector2<float> playerPosition = playerCharacter->GetPosition();
+	_volley.clear();
+	_volleyDirections.clear();
+	for (unsigned int b = 0; b <= _weaponBands[(unsigned int)weaponType]; b++) {
+		for (unsigned int i = 0; i < _rangeBands[b].size(); i++) {
+			EnemyBase* enemy = _rangeBands[b][i];
+			if (enemy->GetWeaponType() == weaponType && enemy->IsWeaponReady()) {
+				_volley.push_back({ enemy->GetPosition(), Vector2<float>(0.f, 0.f), enemy->GetOrientation() });
+				_volleyDirections.emplace_back(playerPosition - enemy->GetPosition());
+				enemy->ResetWeaponCooldown();
+			}
+		}
+	}
+	if (_volley.empty()) {
+		return;
+	}
+	NormalizeVectors(_volleyDirections);
+	for (unsigned int i = 0; i < _volley.size(); i++) {
+		_volley[i].direction = _volleyDirections[i];
+	}
+	projectileManager->SpawnProjectiles(ProjectileType::EnemyProjectile, weaponData.damage, _volley);
+}
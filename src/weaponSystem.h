@@ -0,0 +1,118 @@
+#pragma once
+#include "projectileManager.h"
+#include "vector2.h"
+#include "worldSnapshot.h"
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class EnemyBase;
+class Sprite;
+
+enum class WeaponType {
+	Tusks,
+	Sword,
+	WizardHat,
+	Count
+};
+
+// Melee weapons damage the player directly, ranged weapons fire an enemy projectile.
+enum class WeaponAttack {
+	Melee,
+	Ranged
+};
+
+struct WeaponData {
+	WeaponAttack attack;
+	unsigned int damage;
+	float range;
+	float cooldown;
+	const char* spritePath;
+};
+
+const WeaponData& GetWeaponData(WeaponType weaponType);
+
+// Resolves the attacks of every enemy once per tick, after the enemy update.
+//
+// Instead of every enemy checking its distance to the player, the enemy broadphase is
+// queried once around the player at the longest weapon range. The enemies found are
+// bucketed by range band, one band per distinct weapon range, and each weapon type
+// then only walks the bands within its range.
+//
+// The query only pays off when few enemies are in range. The longest range covers most
+// of the window, and when the enemies crowd around the player a plain pass over all of
+// them is about twice as fast (see --scenario attack). By default the query is used only
+// while the previous tick had at most the sparse fraction of the enemies in range.
+class WeaponSystem {
+public:
+	WeaponSystem();
+	~WeaponSystem() {}
+
+	void ResolveAttacks();
+	// Fills the range bands and returns how many enemies were tested against them.
+	unsigned int GatherAttackers();
+
+	void Render(WeaponType weaponType, Vector2<float> position, float orientation);
+	void AddRenderItem(std::vector<RenderItem>& renderItems, WeaponType weaponType, Vector2<float> position, float orientation) const;
+
+	void UpdateImgui();
+	// Applies what the overlay changed and copies what it shows, once per tick on
+	// the simulation thread.
+	void SyncImgui();
+
+	// Tests every enemy instead of querying around the player, to compare the two.
+	// With adaptive set the query is only used while the enemies are sparse.
+	void SetPlayerQueryEnabled(bool playerQueryEnabled, bool adaptive);
+
+	static const unsigned int rangeBandCount = (unsigned int)WeaponType::Count;
+
+private:
+	// Tunables the overlay can change while the simulation thread ticks.
+	struct Settings {
+		float sparseFraction = 0.3f;
+		bool playerQueryEnabled = true;
+		bool adaptiveQueryEnabled = true;
+	};
+
+	// The values the overlay shows, as of the last tick.
+	struct ImguiStatistics {
+		std::array<unsigned int, rangeBandCount> bandSizes = {};
+		float inRangeFraction = 0.f;
+		unsigned int attackersTested = 0;
+		bool playerQueryUsed = false;
+	};
+
+	void ResolveMeleeAttacks(WeaponType weaponType);
+	void ResolveRangedAttacks(WeaponType weaponType);
+
+	std::array<std::shared_ptr<Sprite>, (unsigned int)WeaponType::Count> _sprites;
+
+	// Band b holds the enemies further away than band b - 1 but within _bandRanges[b].
+	std::array<std::vector<EnemyBase*>, rangeBandCount> _rangeBands;
+	std::array<float, rangeBandCount> _bandRanges = {};
+	std::array<std::string, rangeBandCount> _bandLabels;
+	std::array<unsigned int, (unsigned int)WeaponType::Count> _weaponBands = {};
+	unsigned int _usedBandCount = 0;
+
+	std::vector<std::shared_ptr<EnemyBase>> _queriedEnemies;
+	std::vector<ProjectileSpawn> _volley;
+	std::vector<Vector2<float>> _volleyDirections;
+
+	// Enemies have moved since the broadphase was built, the query is widened by this much.
+	float _queryMargin = 32.f;
+
+	float _inRangeFraction = 0.f;
+
+	unsigned int _attackersTested = 0;
+	bool _playerQueryUsed = false;
+
+	// The simulation reads _settings, the overlay edits _imguiSettings and reads
+	// _imguiStatistics. SyncImgui exchanges them under _imguiMutex.
+	Settings _settings;
+	Settings _imguiSettings;
+	ImguiStatistics _imguiStatistics;
+	std::mutex _imguiMutex;
+};
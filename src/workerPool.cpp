@@ -0,0 +1,115 @@
+#include "workerPool.h"
+
+#include <algorithm>
+
+WorkerPool::WorkerPool(unsigned int threadCount) {
+	StartWorkers(std::max(threadCount, 1u) - 1);
+}
+
+WorkerPool::~WorkerPool() {
+	StopWorkers();
+}
+
+void WorkerPool::Run(unsigned int taskCount, const std::function<void(unsigned int)>& task) {
+	if (taskCount == 0) {
+		return;
+	}
+	std::lock_guard<std::mutex> runLock(_runMutex);
+	if (_workers.empty() || taskCount == 1) {
+		for (unsigned int i = 0; i < taskCount; i++) {
+			task(i);
+		}
+		return;
+	}
+
+	{
+		// A worker that woke up late for the previous batch may still be on its way out.
+		std::unique_lock<std::mutex> lock(_mutex);
+		_doneCondition.wait(lock, [this]() { return _activeWorkers == 0; });
+		_task = &task;
+		_taskCount = taskCount;
+		_nextTask.store(0);
+		_generation++;
+	}
+	_wakeCondition.notify_all();
+
+	RunTasks();
+
+	// Every task has been claimed once RunTasks returns, so the batch is done when
+	// no worker is still running one.
+	std::unique_lock<std::mutex> lock(_mutex);
+	_doneCondition.wait(lock, [this]() { return _activeWorkers == 0; });
+}
+
+void WorkerPool::ParallelFor(unsigned int count, unsigned int grainSize, const std::function<void(unsigned int, unsigned int)>& function) {
+	grainSize = std::max(grainSize, 1u);
+	const unsigned int taskCount = (count + grainSize - 1) / grainSize;
+	Run(taskCount, [&](unsigned int taskIndex) {
+		const unsigned int begin = taskIndex * grainSize;
+		function(begin, std::min(begin + grainSize, count));
+	});
+}
+
+void WorkerPool::SetThreadCount(unsigned int threadCount) {
+	std::lock_guard<std::mutex> runLock(_runMutex);
+	StopWorkers();
+	StartWorkers(std::max(threadCount, 1u) - 1);
+}
+
+const unsigned int WorkerPool::GetThreadCount() const {
+	return (unsigned int)_workers.size() + 1;
+}
+
+void WorkerPool::StartWorkers(unsigned int workerCount) {
+	_stopping = false;
+	for (unsigned int i = 0; i < workerCount; i++) {
+		_workers.emplace_back(&WorkerPool::WorkerLoop, this);
+	}
+}
+
+void WorkerPool::StopWorkers() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_wakeCondition.notify_all();
+	for (unsigned int i = 0; i < _workers.size(); i++) {
+		_workers[i].join();
+	}
+	_workers.clear();
+}
+
+void WorkerPool::WorkerLoop() {
+	unsigned int generation = 0;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		generation = _generation;
+	}
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_wakeCondition.wait(lock, [this, generation]() { return _stopping || _generation != generation; });
+			if (_stopping) {
+				return;
+			}
+			generation = _generation;
+			_activeWorkers++;
+		}
+
+		RunTasks();
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_activeWorkers--;
+		if (_activeWorkers == 0) {
+			_doneCondition.notify_all();
+		}
+	}
+}
+
+void WorkerPool::RunTasks() {
+	unsigned int taskIndex = _nextTask.fetch_add(1);
+	while (taskIndex < _taskCount) {
+		(*_task)(taskIndex);
+		taskIndex = _nextTask.fetch_add(1);
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that run batches of independent tasks. The calling
+// thread works on the batch too and Run returns once every task is done. Tasks
+// must not call Run themselves.
+class WorkerPool {
+public:
+	WorkerPool(unsigned int threadCount);
+	~WorkerPool();
+
+	void Run(unsigned int taskCount, const std::function<void(unsigned int)>& task);
+	void ParallelFor(unsigned int count, unsigned int grainSize, const std::function<void(unsigned int, unsigned int)>& function);
+
+	// Counts the calling thread, so 1 runs everything inline.
+	void SetThreadCount(unsigned int threadCount);
+	const unsigned int GetThreadCount() const;
+
+private:
+	void StartWorkers(unsigned int workerCount);
+	void StopWorkers();
+	void WorkerLoop();
+	void RunTasks();
+
+	std::vector<std::thread> _workers;
+
+	std::mutex _runMutex;
+	std::mutex _mutex;
+	std::condition_variable _wakeCondition;
+	std::condition_variable _doneCondition;
+
+	const std::function<void(unsigned int)>* _task = nullptr;
+	std::atomic<unsigned int> _nextTask = 0;
+	unsigned int _taskCount = 0;
+
+	unsigned int _activeWorkers = 0;
+	unsigned int _generation = 0;
+	bool _stopping = false;
+};
@@ -0,0 +1,42 @@
+#include "worldSnapshot.h"
+
+#include "gameEngine.h"
+#include "sprite.h"
+#include "spriteRasterizer.h"
+
+void WorldSnapshot::Clear() {
+	renderItems.clear();
+	publishTime = 0;
+	playerHealth = 0;
+	tick = 0;
+}
+
+void WorldSnapshot::Render() const {
+	if (spriteRasterizer->IsEnabled()) {
+		spriteRasterizer->Render(renderItems);
+		return;
+	}
+	for (unsigned int i = 0; i < renderItems.size(); i++) {
+		renderItems[i].sprite->RenderWithOrientation(renderItems[i].position, renderItems[i].orientation);
+	}
+}
+
+WorldSnapshot& WorldSnapshotBuffer::GetWriteSnapshot() {
+	return _snapshots[_writeIndex];
+}
+
+void WorldSnapshotBuffer::Publish() {
+	_writeIndex = _middleIndex.exchange(_writeIndex | newSnapshotFlag, std::memory_order_acq_rel) & indexMask;
+}
+
+bool WorldSnapshotBuffer::AcquireLatest() {
+	if ((_middleIndex.load(std::memory_order_relaxed) & newSnapshotFlag) == 0) {
+		return false;
+	}
+	_readIndex = _middleIndex.exchange(_readIndex, std::memory_order_acq_rel) & indexMask;
+	return true;
+}
+
+const WorldSnapshot& WorldSnapshotBuffer::GetReadSnapshot() const {
+	return _snapshots[_readIndex];
+}
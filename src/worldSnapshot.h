@@ -0,0 +1,55 @@
+#pragma once
+#include "vector2.h"
+
+#include <SDL2/SDL.h>
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+struct Sprite;
+
+struct RenderItem {
+	Sprite* sprite = nullptr;
+	Vector2<float> position = Vector2<float>(0.f, 0.f);
+	float orientation = 0.f;
+};
+
+// Everything the render thread needs to draw one simulated tick.
+struct WorldSnapshot {
+	void Clear();
+	void Render() const;
+
+	std::vector<RenderItem> renderItems;
+
+	Uint64 publishTime = 0;
+
+	int playerHealth = 0;
+	int tick = 0;
+};
+
+// Lock-free triple buffer between one writer and one reader. The writer always has a
+// buffer of its own to fill, Publish swaps it with the shared middle buffer and
+// AcquireLatest swaps the middle buffer to the reader when a new one is waiting.
+class WorldSnapshotBuffer {
+public:
+	WorldSnapshotBuffer() {}
+	~WorldSnapshotBuffer() {}
+
+	WorldSnapshot& GetWriteSnapshot();
+	void Publish();
+
+	bool AcquireLatest();
+	const WorldSnapshot& GetReadSnapshot() const;
+
+private:
+	static const unsigned int indexMask = 3;
+	static const unsigned int newSnapshotFlag = 4;
+
+	std::array<WorldSnapshot, 3> _snapshots;
+
+	std::atomic<unsigned int> _middleIndex = 1;
+
+	unsigned int _writeIndex = 0;
+	unsigned int _readIndex = 2;
+};